@@ -0,0 +1,231 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "animation.h"
+#include "transform.h"
+
+/* Seconds for the block to cross the track once */
+static const double SWEEP_SECONDS = 1.2;
+
+/* Default colors: a dim track with a white block */
+static const uint32_t TRACK_COLOR = 0x00303030;
+static const uint32_t BLOCK_COLOR = 0x00ffffff;
+
+/* Current CLOCK_MONOTONIC time in nanoseconds */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Fill a rectangle of the unrotated layout at its rotated screen position
+ * Uses the same mapping as the display transform, about the logo center
+ */
+static void fill_rotated(Framebuffer *fb, const ProgressBar *bar, int x, int y,
+                         int width, int height, uint32_t color)
+{
+    transform_rotate_rect(bar->rotation, bar->center_x, bar->center_y, &x, &y, &width, &height);
+    fb_fill_rect(fb, x, y, width, height, color);
+}
+
+/* Fill columns [offset, offset + width) of the track */
+static void fill_track_part(Framebuffer *fb, const ProgressBar *bar, int offset, int width,
+                            uint32_t color)
+{
+    fill_rotated(fb, bar, bar->x + offset, bar->y, width, bar->height, color);
+}
+
+/* Place the track under the logo and draw it empty */
+void progress_bar_init(Framebuffer *fb, ProgressBar *bar, const DisplayInfo *display_info,
+                       int rotation)
+{
+    int logo_width = display_info->svg_width;
+    int logo_height = display_info->svg_height;
+
+    bar->width = logo_width / 2;
+    bar->height = logo_height / 60 > 4 ? logo_height / 60 : 4;
+    bar->block_width = bar->width / 4 > 1 ? bar->width / 4 : 1;
+    bar->block_x = -1;
+    bar->filled = 0;
+    bar->x = display_info->x_offset + (logo_width - bar->width) / 2;
+    bar->y = display_info->y_offset + logo_height + logo_height / 12;
+    bar->center_x = display_info->x_offset + logo_width / 2;
+    bar->center_y = display_info->y_offset + logo_height / 2;
+    bar->rotation = rotation;
+    bar->track_color = TRACK_COLOR;
+    bar->block_color = BLOCK_COLOR;
+
+    // Keep the track on screen when the logo leaves no room beneath it
+    if (bar->y + bar->height > (int)display_info->screen_height)
+    {
+        bar->y = display_info->screen_height - 2 * bar->height;
+    }
+
+    fill_track_part(fb, bar, 0, bar->width, bar->track_color);
+}
+
+/* Slide the block and repaint only the columns whose color changed */
+void progress_bar_update(Framebuffer *fb, ProgressBar *bar, double seconds)
+{
+    int travel = bar->width - bar->block_width;
+    if (travel <= 0)
+    {
+        return;
+    }
+
+    // Triangle wave: across the track and back
+    double phase = fmod(seconds / SWEEP_SECONDS, 2.0);
+    if (phase > 1.0)
+    {
+        phase = 2.0 - phase;
+    }
+
+    int new_x = (int)(phase * travel + 0.5);
+    int old_x = bar->block_x;
+    int block = bar->block_width;
+
+    if (new_x == old_x)
+    {
+        return;
+    }
+
+    if (old_x < 0 || abs(new_x - old_x) >= block)
+    {
+        // No overlap: erase the old block and draw the new one
+        if (old_x >= 0)
+        {
+            fill_track_part(fb, bar, old_x, block, bar->track_color);
+        }
+        fill_track_part(fb, bar, new_x, block, bar->block_color);
+    }
+    else if (new_x > old_x)
+    {
+        fill_track_part(fb, bar, old_x, new_x - old_x, bar->track_color);
+        fill_track_part(fb, bar, old_x + block, new_x - old_x, bar->block_color);
+    }
+    else
+    {
+        fill_track_part(fb, bar, new_x, old_x - new_x, bar->block_color);
+        fill_track_part(fb, bar, new_x + block, old_x - new_x, bar->track_color);
+    }
+
+    bar->block_x = new_x;
+}
+
+/* Grow or shrink the fill, repainting only the columns that change */
+void progress_bar_set(Framebuffer *fb, ProgressBar *bar, int percent)
+{
+    percent = percent < 0 ? 0 : (percent > 100 ? 100 : percent);
+    int filled = bar->width * percent / 100;
+
+    if (filled > bar->filled)
+    {
+        fill_track_part(fb, bar, bar->filled, filled - bar->filled, bar->block_color);
+    }
+    else if (filled < bar->filled)
+    {
+        fill_track_part(fb, bar, filled, bar->filled - filled, bar->track_color);
+    }
+
+    bar->filled = filled;
+}
+
+/* Track, then the fill and the sliding block over it */
+void progress_bar_draw(Framebuffer *fb, const ProgressBar *bar)
+{
+    fill_track_part(fb, bar, 0, bar->width, bar->track_color);
+    if (bar->filled > 0)
+    {
+        fill_track_part(fb, bar, 0, bar->filled, bar->block_color);
+    }
+    if (bar->block_x >= 0)
+    {
+        fill_track_part(fb, bar, bar->block_x, bar->block_width, bar->block_color);
+    }
+}
+
+/* Frame loop paced by a periodic timerfd
+ * Each read returns the number of periods since the last one; the frame is
+ * drawn for the latest period and the rest are counted as missed.
+ */
+int animation_run(Framebuffer *fb, ProgressBar *bar, unsigned fps, double duration,
+                  volatile sig_atomic_t *stop, AnimationStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    if (fps == 0 || fps > 1000)
+    {
+        return -1;
+    }
+
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tfd == -1)
+    {
+        return -1;
+    }
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_interval.tv_nsec = 1000000000L / fps;
+    spec.it_value = spec.it_interval;
+    if (fps == 1)
+    {
+        spec.it_interval.tv_sec = spec.it_value.tv_sec = 1;
+        spec.it_interval.tv_nsec = spec.it_value.tv_nsec = 0;
+    }
+    if (timerfd_settime(tfd, 0, &spec, NULL) == -1)
+    {
+        close(tfd);
+        return -1;
+    }
+
+    uint64_t limit = duration > 0 ? (uint64_t)(duration * fps) : 0;
+    uint64_t tick = 0;
+    stats->render_ns_min = UINT64_MAX;
+
+    while (!*stop && (limit == 0 || tick < limit))
+    {
+        uint64_t expirations;
+        ssize_t n = read(tfd, &expirations, sizeof(expirations));
+        if (n != (ssize_t)sizeof(expirations))
+        {
+            if (n == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+
+        tick += expirations;
+        stats->missed += expirations - 1;
+
+        uint64_t start = now_ns();
+        progress_bar_update(fb, bar, (double)tick / fps);
+        fb_present(fb);
+        uint64_t elapsed = now_ns() - start;
+
+        stats->frames++;
+        stats->render_ns_total += elapsed;
+        if (elapsed < stats->render_ns_min)
+        {
+            stats->render_ns_min = elapsed;
+        }
+        if (elapsed > stats->render_ns_max)
+        {
+            stats->render_ns_max = elapsed;
+        }
+    }
+
+    if (stats->frames == 0)
+    {
+        stats->render_ns_min = 0;
+    }
+
+    close(tfd);
+    return 0;
+}
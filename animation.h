@@ -0,0 +1,75 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <stdint.h>
+#include <signal.h>
+#include "fbsplash.h"
+
+/* Progress bar drawn under the logo
+ * Indeterminate, a block slides back and forth along a track; determinate,
+ * the track fills from the left. Coordinates are in the unrotated layout
+ * and mapped to the screen when drawn.
+ * x, y, width, height: Track rectangle
+ * block_width: Width of the moving block
+ * block_x: Block offset into the track, -1 before the first frame
+ * filled: Determinate fill in columns from the left, 0 while empty
+ * center_x, center_y: Point the layout is rotated about
+ * rotation: Device tree rotation in degrees
+ * track_color, block_color: 32-bit RGBA color values
+ */
+typedef struct {
+    int x;
+    int y;
+    int width;
+    int height;
+    int block_width;
+    int block_x;
+    int filled;
+    int center_x;
+    int center_y;
+    int rotation;
+    uint32_t track_color;
+    uint32_t block_color;
+} ProgressBar;
+
+/* Frame timing collected by animation_run */
+typedef struct {
+    uint64_t frames;          // Frames drawn
+    uint64_t missed;          // Timer periods skipped because a frame ran late
+    uint64_t render_ns_min;   // Fastest frame, draw and present
+    uint64_t render_ns_max;   // Slowest frame
+    uint64_t render_ns_total; // Sum over all frames
+} AnimationStats;
+
+/* Lay out the bar centered under the logo and draw its empty track
+ * rotation: Device tree rotation, applied around the logo center
+ */
+void progress_bar_init(Framebuffer *fb, ProgressBar *bar, const DisplayInfo *display_info,
+                       int rotation);
+
+/* Move the block to its position at time seconds
+ * Only the strips the block leaves or enters are redrawn.
+ */
+void progress_bar_update(Framebuffer *fb, ProgressBar *bar, double seconds);
+
+/* Fill the bar to percent (clamped to 0-100) of its track
+ * Only the columns between the old and the new fill are redrawn.
+ */
+void progress_bar_set(Framebuffer *fb, ProgressBar *bar, int percent);
+
+/* Redraw the whole bar in its current state, e.g. after the frame under
+ * it was repainted
+ */
+void progress_bar_draw(Framebuffer *fb, const ProgressBar *bar);
+
+/* Drive the bar from a timerfd at fps frames per second and present each frame
+ * Late frames are dropped rather than queued, so the animation keeps wall
+ * clock time and never catches up in a burst.
+ * duration: Seconds to run, 0 to run until *stop becomes non-zero
+ * stop: Set asynchronously (e.g. from a signal handler) to end the loop
+ * Returns: 0 when done, -1 if the timer could not be set up
+ */
+int animation_run(Framebuffer *fb, ProgressBar *bar, unsigned fps, double duration,
+                  volatile sig_atomic_t *stop, AnimationStats *stats);
+
+#endif
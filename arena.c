@@ -0,0 +1,128 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdalign.h>
+#include "arena.h"
+
+/* Alignment of every allocation */
+#define ARENA_ALIGN alignof(max_align_t)
+
+/* One contiguous chunk; data follows the header */
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *next;  // Previously filled block
+    size_t size;              // Usable bytes
+    size_t used;              // Bytes handed out
+    alignas(ARENA_ALIGN) unsigned char data[];
+} ArenaBlock;
+
+struct Arena
+{
+    ArenaBlock *head;         // Block allocations come from; older ones follow
+    size_t total;             // Usable bytes across all blocks
+};
+
+static ArenaBlock *block_create(size_t size)
+{
+    ArenaBlock *block = malloc(sizeof(ArenaBlock) + size);
+    if (!block)
+        return NULL;
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+static void free_blocks(ArenaBlock *block)
+{
+    while (block)
+    {
+        ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
+/* Create an arena with one block */
+Arena *arena_create(size_t block_size)
+{
+    Arena *arena = malloc(sizeof(Arena));
+    if (!arena)
+        return NULL;
+
+    arena->head = block_create(block_size);
+    if (!arena->head)
+    {
+        free(arena);
+        return NULL;
+    }
+    arena->total = block_size;
+    return arena;
+}
+
+/* Bump the head block, chaining a block at least twice the total when full */
+void *arena_alloc(Arena *arena, size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (size == 0)
+        size = ARENA_ALIGN;
+
+    ArenaBlock *block = arena->head;
+    if (size > block->size - block->used)
+    {
+        size_t block_size = arena->total * 2;
+        if (block_size < size)
+            block_size = size;
+
+        block = block_create(block_size);
+        if (!block)
+            return NULL;
+        block->next = arena->head;
+        arena->head = block;
+        arena->total += block_size;
+    }
+
+    void *ptr = block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+/* Allocate an array, failing rather than wrapping on overflow */
+void *arena_alloc_array(Arena *arena, size_t count, size_t size)
+{
+    if (size != 0 && count > SIZE_MAX / size - ARENA_ALIGN)
+        return NULL;
+    return arena_alloc(arena, count * size);
+}
+
+/* Empty the arena; a chain is merged into one block of the combined size */
+void arena_reset(Arena *arena)
+{
+    ArenaBlock *head = arena->head;
+    if (head->next)
+    {
+        ArenaBlock *merged = block_create(arena->total);
+        if (merged)
+        {
+            free_blocks(head);
+            arena->head = head = merged;
+        }
+        else
+        {
+            // Keep the newest (largest) block if the merged one cannot be had
+            free_blocks(head->next);
+            head->next = NULL;
+            arena->total = head->size;
+        }
+    }
+    head->used = 0;
+}
+
+/* Free all blocks and the arena itself */
+void arena_destroy(Arena *arena)
+{
+    if (arena)
+    {
+        free_blocks(arena->head);
+        free(arena);
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/* Bump allocator for geometry that lives exactly as long as a scene
+ * Allocations are carved from one block and released together. A request
+ * that does not fit chains a larger block; arena_reset then replaces the
+ * chain with a single block big enough for everything, so a repeated scene
+ * settles at one block, one malloc and one free.
+ */
+typedef struct Arena Arena;
+
+/* Create an arena
+ * block_size: Bytes in the first block
+ * Returns: Arena, or NULL on failure
+ */
+Arena *arena_create(size_t block_size);
+
+/* Allocate size bytes aligned for any type
+ * Returns: Memory valid until the next arena_reset or arena_destroy,
+ *          or NULL on failure
+ */
+void *arena_alloc(Arena *arena, size_t size);
+
+/* Allocate count elements of size bytes, checking the multiplication */
+void *arena_alloc_array(Arena *arena, size_t count, size_t size);
+
+/* Release every allocation, keeping the memory for reuse */
+void arena_reset(Arena *arena);
+
+/* Free an arena and everything allocated from it */
+void arena_destroy(Arena *arena);
+
+#endif
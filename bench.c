@@ -0,0 +1,568 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "fbsplash.h"
+#include "fb_headless.h"
+#include "svg_parser.h"
+#include "svg_flatten.h"
+#include "svg_document.h"
+#include "svg_renderer.h"
+#include "fixed_point.h"
+#include "thread_pool.h"
+#include "logo.h"
+
+/*
+ * Stage benchmarks
+ *
+ * Times SVG loading, parsing, flattening, scene compositing (also rotated)
+ * and clearing on their own against in-memory framebuffers, plus synthetic
+ * scenes with many edges to show how the compositor scales. Every stage is repeated and reported as
+ * min/median/p99 so results can be compared across releases.
+ */
+
+/* Output formats */
+typedef enum {
+    OUTPUT_CSV,
+    OUTPUT_JSON
+} OutputFormat;
+
+/* Settings shared by every stage */
+typedef struct {
+    int max_runs;            // Samples per stage at most
+    double budget;           // Seconds per stage before sampling stops early
+    int threads;             // Render threads
+    OutputFormat format;     // Report format
+    int rows_written;        // Result rows printed so far
+} BenchConfig;
+
+/* Screen sizes timed by the composite and clear stages */
+static const struct {
+    int width;
+    int height;
+} screen_sizes[] = {
+    { 640, 480 },
+    { 1920, 1080 },
+    { 3840, 2160 },
+    { 7680, 4320 },
+};
+
+/* Edge counts of the synthetic scenes */
+static const int synthetic_edges[] = { 10000, 100000, 1000000 };
+
+/* Path coordinates of this build, reported with every row so float and
+ * 16.16 fixed-point results stay apart
+ */
+#ifdef SPLASH_FIXED_POINT
+#define BENCH_COORDS "fixed"
+#else
+#define BENCH_COORDS "float"
+#endif
+
+/* Samples always taken, even over budget */
+#define MIN_RUNS 3
+
+/* Current CLOCK_MONOTONIC time in nanoseconds */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Sort helper for sample arrays */
+static int compare_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Print one result row from unsorted samples */
+static void report(BenchConfig *config, const char *stage, const char *variant,
+                   uint64_t *samples, int count)
+{
+    qsort(samples, count, sizeof(uint64_t), compare_u64);
+
+    int p99 = (int)ceil(count * 0.99) - 1;
+    double min_us = samples[0] / 1e3;
+    double median_us = (count % 2) ? samples[count / 2] / 1e3
+                                   : (samples[count / 2 - 1] + samples[count / 2]) / 2e3;
+    double p99_us = samples[p99 < 0 ? 0 : p99] / 1e3;
+
+    if (config->format == OUTPUT_JSON)
+    {
+        printf("%s  {\"stage\": \"%s\", \"variant\": \"%s\", \"coords\": \"%s\", \"threads\": %d, "
+               "\"runs\": %d, \"min_us\": %.3f, \"median_us\": %.3f, \"p99_us\": %.3f}",
+               config->rows_written ? ",\n" : "", stage, variant, BENCH_COORDS, config->threads,
+               count, min_us, median_us, p99_us);
+    }
+    else
+    {
+        printf("%s,%s,%s,%d,%d,%.3f,%.3f,%.3f\n", stage, variant, BENCH_COORDS, config->threads,
+               count, min_us, median_us, p99_us);
+    }
+    config->rows_written++;
+    fflush(stdout);
+}
+
+/* Sample fn(ctx) until max_runs or the time budget is used up, then report it */
+static void run_stage(BenchConfig *config, const char *stage, const char *variant,
+                      void (*fn)(void *ctx), void *ctx)
+{
+    uint64_t *samples = malloc(config->max_runs * sizeof(uint64_t));
+    if (!samples)
+    {
+        return;
+    }
+
+    uint64_t deadline = now_ns() + (uint64_t)(config->budget * 1e9);
+    int count = 0;
+    while (count < config->max_runs && (count < MIN_RUNS || now_ns() < deadline))
+    {
+        uint64_t start = now_ns();
+        fn(ctx);
+        samples[count++] = now_ns() - start;
+    }
+
+    report(config, stage, variant, samples, count);
+    free(samples);
+}
+
+/* Parse every logo path from its source string */
+static void bench_parse(void *ctx)
+{
+    (void)ctx;
+    for (size_t i = 0; i < logo_num_paths; i++)
+    {
+        free_svg_outline(parse_svg_outline(svg_paths[i], svg_colors[i]));
+    }
+}
+
+/* Append to a growable array, doubling its capacity as needed */
+static bool legacy_append(void **array, uint32_t *count, uint32_t *capacity, size_t size,
+                          const void *items, uint32_t num_items)
+{
+    if (*count + num_items > *capacity)
+    {
+        uint32_t new_capacity = *capacity * 2 + num_items;
+        void *grown = realloc(*array, new_capacity * size);
+        if (!grown)
+        {
+            return false;
+        }
+        *array = grown;
+        *capacity = new_capacity;
+    }
+    memcpy((char *)*array + *count * size, items, num_items * size);
+    *count += num_items;
+    return true;
+}
+
+/* The path parser as it was before the hand-rolled scanner, kept as a
+ * baseline: strtof per number, ctype per character, absolute M/L/H/V/C/Z
+ */
+static SVGOutline *legacy_parse_outline(const char *p)
+{
+    SVGOutline *outline = calloc(1, sizeof(SVGOutline));
+    if (!outline)
+    {
+        return NULL;
+    }
+
+    char command = 'M';
+    Point current = { 0, 0 };
+    bool ok = true;
+    while (*p && ok)
+    {
+        if (isalpha((unsigned char)*p))
+        {
+            command = *p++;
+        }
+
+        uint8_t verb;
+        int count = command == 'C' ? 3 : command == 'Z' || command == 'z' ? 0 : 1;
+        Point pts[3];
+        for (int i = 0; i < count; i++)
+        {
+            float v[2];
+            int n = (command == 'H' || command == 'V') ? 1 : 2;
+            for (int j = 0; j < n; j++)
+            {
+                while (isspace((unsigned char)*p) || *p == ',')
+                    p++;
+                char *end;
+                v[j] = strtof(p, &end);
+                p = end;
+            }
+            pts[i].x = command == 'V' ? current.x : v[0];
+            pts[i].y = command == 'H' ? current.y : command == 'V' ? v[0] : v[1];
+        }
+
+        switch (command)
+        {
+            case 'M': verb = PATH_MOVE; command = 'L'; break;
+            case 'C': verb = PATH_CUBIC; break;
+            case 'Z': case 'z': verb = PATH_CLOSE; break;
+            default: verb = PATH_LINE; break;
+        }
+        if (count)
+        {
+            current = pts[count - 1];
+        }
+        ok = legacy_append((void **)&outline->verbs, &outline->num_verbs,
+                           &outline->verb_capacity, 1, &verb, 1) &&
+             legacy_append((void **)&outline->points, &outline->num_points,
+                           &outline->point_capacity, sizeof(Point), pts, count);
+
+        while (isspace((unsigned char)*p))
+            p++;
+    }
+    return outline;
+}
+
+/* Parse every logo path with the legacy parser */
+static void bench_parse_legacy(void *ctx)
+{
+    (void)ctx;
+    for (size_t i = 0; i < logo_num_paths; i++)
+    {
+        free_svg_outline(legacy_parse_outline(svg_paths[i]));
+    }
+}
+
+/* Size of the generated document timed by the load stage
+ * The target is mapping, parsing and building every outline of it in
+ * under 1 ms; compare the stage's min_us against 1000.
+ */
+#define LOAD_DOCUMENT_BYTES (512 * 1024)
+
+/* Write an SVG file repeating the logo paths until it holds at least min_bytes
+ * Returns: 0 on success, -1 on failure
+ */
+static int write_test_document(const char *path, size_t min_bytes)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        return -1;
+    }
+
+    long written = fprintf(f, "<?xml version=\"1.0\"?>\n"
+                           "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"%g %g %g %g\">\n",
+                           svg_view_box.x, svg_view_box.y, svg_view_box.width, svg_view_box.height);
+    for (size_t i = 0; written > 0 && (size_t)written < min_bytes; i++)
+    {
+        size_t n = i % logo_num_paths;
+        written += fprintf(f, "  <g transform=\"translate(%zu 0)\">\n"
+                           "    <path style=\"fill:%s\" d=\"%s\"/>\n  </g>\n",
+                           i % 7, svg_colors[n], svg_paths[n]);
+    }
+    fprintf(f, "</svg>\n");
+
+    bool failed = ferror(f);
+    return fclose(f) == 0 && !failed ? 0 : -1;
+}
+
+/* Map and parse the generated document */
+static void bench_load(void *ctx)
+{
+    svg_document_free(svg_document_load(ctx));
+}
+
+/* First block of each scene arena */
+#define SCENE_ARENA_SIZE (256 * 1024)
+
+/* Logo flattened for one screen, with its render target */
+typedef struct {
+    Framebuffer *fb;
+    DisplayInfo *display_info;
+    Arena *arena;          // Geometry of the paths below
+    Arena *scratch;        // Reset by every flatten run
+    SVGPath *paths[16];
+    size_t num_paths;
+    float tolerance;
+    RenderMode mode;
+    SceneCompositor compositor;
+} LogoScene;
+
+/* Flatten the baked logo for the scene's scale, as a scene would */
+static void bench_flatten(void *ctx)
+{
+    LogoScene *scene = ctx;
+    arena_reset(scene->scratch);
+    for (size_t i = 0; i < logo_geometry_count; i++)
+    {
+        flatten_svg_outline(&logo_geometry[i], scene->tolerance, scene->scratch);
+    }
+}
+
+/* Build a scene of every flattened path and composite the whole frame */
+static void bench_composite(void *ctx)
+{
+    LogoScene *scene = ctx;
+    RenderScene *composite = render_scene_create(scene->display_info, scene->mode, 0x00000000);
+    if (!composite)
+        return;
+    render_scene_set_compositor(composite, scene->compositor);
+    for (size_t i = 0; i < scene->num_paths; i++)
+    {
+        render_scene_add_path(composite, scene->paths[i]);
+    }
+    render_scene_draw(scene->fb, composite);
+    render_scene_free(composite);
+}
+
+/* Fill the whole screen */
+static void bench_clear(void *ctx)
+{
+    LogoScene *scene = ctx;
+    render_clear(scene->fb, 0x00000000);
+}
+
+/* Open a memory framebuffer and lay out the logo on it
+ * Returns: 0 on success, -1 on failure
+ */
+static int open_scene(LogoScene *scene, int width, int height)
+{
+    char spec[64];
+    snprintf(spec, sizeof(spec), "mem:%dx%d", width, height);
+
+    memset(scene, 0, sizeof(*scene));
+    scene->fb = fb_open(spec);
+    if (!scene->fb)
+    {
+        return -1;
+    }
+
+    scene->display_info = calculate_display_info(scene->fb, 0, &logo_view_box);
+    scene->arena = arena_create(SCENE_ARENA_SIZE);
+    scene->scratch = arena_create(SCENE_ARENA_SIZE);
+    if (!scene->display_info || !scene->arena || !scene->scratch)
+    {
+        arena_destroy(scene->arena);
+        arena_destroy(scene->scratch);
+        free(scene->display_info);
+        fb_cleanup(scene->fb);
+        return -1;
+    }
+
+    scene->tolerance = SCREEN_FLATTEN_TOLERANCE / get_svg_scale(scene->display_info);
+    for (size_t i = 0; i < logo_geometry_count && i < 16; i++)
+    {
+        scene->paths[scene->num_paths] = flatten_svg_outline(&logo_geometry[i], scene->tolerance,
+                                                             scene->arena);
+        if (scene->paths[scene->num_paths])
+        {
+            scene->num_paths++;
+        }
+    }
+
+    return 0;
+}
+
+/* Free a scene and its framebuffer */
+static void close_scene(LogoScene *scene)
+{
+    arena_destroy(scene->arena);
+    arena_destroy(scene->scratch);
+    free(scene->display_info);
+    fb_cleanup(scene->fb);
+}
+
+/* Edges of each star in the synthetic scenes */
+#define STAR_EDGES 64
+
+/* Grid of small star polygons with num_edges edges in total
+ * Stars alternate between two radii, so every row crosses many short edges
+ * of many polygons, stressing edge setup and the active edge list.
+ * Returns: New SVGPath owned by arena or NULL on failure
+ */
+static SVGPath *make_star_grid(int num_edges, Arena *arena)
+{
+    int num_stars = num_edges / STAR_EDGES;
+    int grid = (int)ceil(sqrt((double)num_stars));
+    double cell = logo_view_box.width / grid;
+
+    SVGPath *svg = arena_alloc(arena, sizeof(SVGPath));
+    Path *paths = arena_alloc_array(arena, num_stars, sizeof(Path));
+    PathPoint *all_points = arena_alloc_array(arena, (size_t)num_stars * STAR_EDGES,
+                                              sizeof(PathPoint));
+    if (!svg || !paths || !all_points)
+    {
+        return NULL;
+    }
+    svg->points = all_points;
+    svg->num_points = num_stars * STAR_EDGES;
+    svg->paths = paths;
+    svg->num_paths = num_stars;
+    svg->fill_color = (Color){ 255, 255, 255, 255 };
+
+    for (int s = 0; s < num_stars; s++)
+    {
+        PathPoint *points = all_points + s * STAR_EDGES;
+        double center_x = (s % grid + 0.5) * cell;
+        double center_y = (s / grid + 0.5) * cell;
+        for (int i = 0; i < STAR_EDGES; i++)
+        {
+            double angle = 2.0 * M_PI * i / STAR_EDGES;
+            double radius = cell * ((i & 1) ? 0.2 : 0.45);
+            points[i].x = coord_from_float((float)(center_x + radius * cos(angle)));
+            points[i].y = coord_from_float((float)(center_y + radius * sin(angle)));
+        }
+
+        // Separate outlines, not holes: even-odd parity keeps each one filled
+        paths[s].offset = s * STAR_EDGES;
+        paths[s].num_points = STAR_EDGES;
+        paths[s].is_hole = false;
+    }
+
+    return svg;
+}
+
+/* Print command line usage */
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [-r runs] [-b seconds] [-j threads] [-f csv|json]\n"
+            "  -r  Samples per stage at most (default: 100)\n"
+            "  -b  Time budget per stage in seconds (default: 1)\n"
+            "  -j  Render threads (default: 1)\n"
+            "  -f  Output format (default: csv)\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    BenchConfig config = { 100, 1.0, 1, OUTPUT_CSV, 0 };
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:b:j:f:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r':
+                config.max_runs = atoi(optarg);
+                break;
+            case 'b':
+                config.budget = strtod(optarg, NULL);
+                break;
+            case 'j':
+                config.threads = atoi(optarg);
+                break;
+            case 'f':
+                config.format = strcmp(optarg, "json") == 0 ? OUTPUT_JSON : OUTPUT_CSV;
+                break;
+            case 'h':
+                usage(argv[0]);
+                return 0;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (config.max_runs < MIN_RUNS)
+    {
+        config.max_runs = MIN_RUNS;
+    }
+
+    ThreadPool *pool = thread_pool_create(config.threads);
+    config.threads = thread_pool_size(pool);
+    set_render_thread_pool(pool);
+
+    if (config.format == OUTPUT_JSON)
+        printf("[\n");
+    else
+        printf("stage,variant,coords,threads,runs,min_us,median_us,p99_us\n");
+
+    run_stage(&config, "parse", "logo", bench_parse, NULL);
+    run_stage(&config, "parse", "logo_strtof", bench_parse_legacy, NULL);
+
+    char document_path[] = "/tmp/mess-bench-XXXXXX";
+    int document_fd = mkstemp(document_path);
+    if (document_fd != -1)
+    {
+        close(document_fd);
+        if (write_test_document(document_path, LOAD_DOCUMENT_BYTES) == 0)
+        {
+            run_stage(&config, "load", "512KB", bench_load, document_path);
+        }
+        unlink(document_path);
+    }
+
+    for (size_t s = 0; s < sizeof(screen_sizes) / sizeof(screen_sizes[0]); s++)
+    {
+        LogoScene scene;
+        char variant[32];
+        snprintf(variant, sizeof(variant), "%dx%d", screen_sizes[s].width, screen_sizes[s].height);
+
+        if (open_scene(&scene, screen_sizes[s].width, screen_sizes[s].height) != 0)
+        {
+            fprintf(stderr, "Failed to set up %s\n", variant);
+            continue;
+        }
+
+        run_stage(&config, "flatten", variant, bench_flatten, &scene);
+        run_stage(&config, "clear", variant, bench_clear, &scene);
+        run_stage(&config, "composite", variant, bench_composite, &scene);
+        scene.compositor = SCENE_TILES;
+        run_stage(&config, "composite_tiles", variant, bench_composite, &scene);
+        scene.compositor = SCENE_STRIPS;
+        scene.mode = RENDER_ANTIALIASED;
+        run_stage(&config, "composite_aa", variant, bench_composite, &scene);
+        scene.compositor = SCENE_TILES;
+        run_stage(&config, "composite_aa_tiles", variant, bench_composite, &scene);
+        scene.compositor = SCENE_STRIPS;
+
+        // Rotation is folded into the edge transform; rotated frames should match
+        if (s == 1)
+        {
+            static const int angles[] = { 90, 180, 270 };
+            scene.mode = RENDER_ALIASED;
+            for (size_t a = 0; a < 3; a++)
+            {
+                char name[sizeof(variant) + 16];    // variant, "_rot" and any int
+                snprintf(name, sizeof(name), "%s_rot%d", variant, angles[a]);
+                scene.display_info->rotation = angles[a];
+                run_stage(&config, "composite", name, bench_composite, &scene);
+            }
+        }
+
+        close_scene(&scene);
+    }
+
+    for (size_t e = 0; e < sizeof(synthetic_edges) / sizeof(synthetic_edges[0]); e++)
+    {
+        LogoScene scene;
+        char variant[32];
+        snprintf(variant, sizeof(variant), "stars%d", synthetic_edges[e]);
+
+        if (open_scene(&scene, 1920, 1080) != 0)
+        {
+            continue;
+        }
+
+        // Replace the logo with the synthetic scene
+        arena_reset(scene.arena);
+        scene.paths[0] = make_star_grid(synthetic_edges[e], scene.arena);
+        scene.num_paths = scene.paths[0] ? 1 : 0;
+
+        if (scene.num_paths)
+        {
+            run_stage(&config, "composite", variant, bench_composite, &scene);
+            scene.mode = RENDER_ANTIALIASED;
+            run_stage(&config, "composite_aa", variant, bench_composite, &scene);
+        }
+        close_scene(&scene);
+    }
+
+    if (config.format == OUTPUT_JSON)
+        printf("\n]\n");
+
+    set_render_thread_pool(NULL);
+    thread_pool_destroy(pool);
+    return 0;
+}
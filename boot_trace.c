@@ -0,0 +1,117 @@
+#ifdef SPLASH_TRACE
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "boot_trace.h"
+
+/* tracefs mount points, newest first */
+static const char *const trace_marker_paths[] = {
+    "/sys/kernel/tracing/trace_marker",
+    "/sys/kernel/debug/tracing/trace_marker",
+};
+
+/* Kernel log level prefix for informational messages */
+#define KMSG_PREFIX "<6>"
+
+static TraceSink trace_sink = TRACE_SINK_NONE;
+static int trace_fd = -1;
+
+/* Read a clock in nanoseconds */
+static uint64_t clock_ns(clockid_t clock)
+{
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Open the named sink */
+int boot_trace_open(const char *sink)
+{
+    boot_trace_close();
+
+    if (strcmp(sink, "stderr") == 0)
+    {
+        trace_fd = STDERR_FILENO;
+        trace_sink = TRACE_SINK_STDERR;
+    }
+    else if (strcmp(sink, "kmsg") == 0)
+    {
+        trace_fd = open("/dev/kmsg", O_WRONLY | O_CLOEXEC);
+        trace_sink = TRACE_SINK_KMSG;
+    }
+    else if (strcmp(sink, "trace_marker") == 0)
+    {
+        for (size_t i = 0; i < sizeof(trace_marker_paths) / sizeof(trace_marker_paths[0]); i++)
+        {
+            trace_fd = open(trace_marker_paths[i], O_WRONLY | O_CLOEXEC);
+            if (trace_fd != -1)
+            {
+                break;
+            }
+        }
+        trace_sink = TRACE_SINK_TRACE_MARKER;
+    }
+
+    if (trace_fd == -1)
+    {
+        trace_sink = TRACE_SINK_NONE;
+        return -1;
+    }
+    return 0;
+}
+
+/* Read CLOCK_BOOTTIME and CLOCK_MONOTONIC */
+TraceStamp boot_trace_now(void)
+{
+    TraceStamp stamp;
+    stamp.boottime_ns = clock_ns(CLOCK_BOOTTIME);
+    stamp.monotonic_ns = clock_ns(CLOCK_MONOTONIC);
+    return stamp;
+}
+
+/* Format the phase line and write it with a single write()
+ * kmsg and trace_marker turn each write into one record
+ */
+void boot_trace_phase(const char *phase, int index, TraceStamp start)
+{
+    if (trace_sink == TRACE_SINK_NONE)
+    {
+        return;
+    }
+
+    uint64_t duration_ns = clock_ns(CLOCK_MONOTONIC) - start.monotonic_ns;
+    char line[256];
+    int length = snprintf(line, sizeof(line),
+                          "%smess-splash: phase=%s index=%d boottime_us=%llu monotonic_us=%llu duration_us=%llu\n",
+                          trace_sink == TRACE_SINK_KMSG ? KMSG_PREFIX : "", phase, index,
+                          (unsigned long long)(start.boottime_ns / 1000),
+                          (unsigned long long)(start.monotonic_ns / 1000),
+                          (unsigned long long)(duration_ns / 1000));
+    if (length <= 0)
+    {
+        return;
+    }
+    if (length >= (int)sizeof(line))
+    {
+        length = sizeof(line) - 1;
+    }
+
+    ssize_t written = write(trace_fd, line, length);
+    (void)written;
+}
+
+/* Close the sink unless it is stderr */
+void boot_trace_close(void)
+{
+    if (trace_fd >= 0 && trace_sink != TRACE_SINK_STDERR)
+    {
+        close(trace_fd);
+    }
+    trace_fd = -1;
+    trace_sink = TRACE_SINK_NONE;
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef BOOT_TRACE_H
+#define BOOT_TRACE_H
+
+/* Boot-phase timing
+ * Built only with -DSPLASH_TRACE (make TRACE=1); otherwise every macro below
+ * expands to nothing and no timing code is compiled in.
+ *
+ * Each finished phase is written as one line of key=value pairs:
+ *
+ *   mess-splash: phase=fb_init index=-1 boottime_us=812345 monotonic_us=801234 duration_us=412
+ *
+ * boottime_us and monotonic_us are the phase start on CLOCK_BOOTTIME and
+ * CLOCK_MONOTONIC, so lines can be matched against systemd-analyze (boot
+ * time) and ftrace timestamps (monotonic).
+ */
+
+#ifdef SPLASH_TRACE
+
+#include <stdint.h>
+
+/* Where trace lines are written */
+typedef enum {
+    TRACE_SINK_NONE,          // Tracing off
+    TRACE_SINK_STDERR,        // Standard error
+    TRACE_SINK_KMSG,          // /dev/kmsg, shows up in dmesg
+    TRACE_SINK_TRACE_MARKER   // tracefs trace_marker, shows up in ftrace
+} TraceSink;
+
+/* Start of a phase on both clocks */
+typedef struct {
+    uint64_t boottime_ns;
+    uint64_t monotonic_ns;
+} TraceStamp;
+
+/* Select the sink by name: "stderr", "kmsg" or "trace_marker"
+ * Returns: 0 on success, -1 for an unknown name or a sink that cannot be opened
+ */
+int boot_trace_open(const char *sink);
+
+/* Read both clocks */
+TraceStamp boot_trace_now(void);
+
+/* Write the line for a phase that began at start
+ * index: Item number for repeated phases (such as one per path), -1 if none
+ */
+void boot_trace_phase(const char *phase, int index, TraceStamp start);
+
+/* Close the sink */
+void boot_trace_close(void);
+
+#define BOOT_TRACE_OPEN(sink) boot_trace_open(sink)
+#define BOOT_TRACE_BEGIN(stamp) TraceStamp stamp = boot_trace_now()
+#define BOOT_TRACE_END(stamp, phase, index) boot_trace_phase(phase, index, stamp)
+#define BOOT_TRACE_CLOSE() boot_trace_close()
+
+#else
+
+#define BOOT_TRACE_OPEN(sink) (-1)
+#define BOOT_TRACE_BEGIN(stamp) do { } while (0)
+#define BOOT_TRACE_END(stamp, phase, index) do { } while (0)
+#define BOOT_TRACE_CLOSE() do { } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,276 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "coverage.h"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define COVERAGE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define COVERAGE_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* Allocate a zeroed accumulation buffer
+ * Rows are padded to a multiple of four floats for the vector resolve
+ */
+int coverage_init(CoverageBuffer *cov, int width, int height)
+{
+    cov->width = width;
+    cov->height = height;
+    cov->stride = (width + 2 + 3) & ~3;
+    cov->cells = calloc((size_t)cov->stride * height, sizeof(float));
+    return cov->cells ? 0 : -1;
+}
+
+/* Free the accumulation cells */
+void coverage_free(CoverageBuffer *cov)
+{
+    free(cov->cells);
+    cov->cells = NULL;
+}
+
+/* Accumulate a line lying inside 0 <= x <= width, y0 < y1, 0 <= y <= height
+ * For every row it crosses, the signed area to the right of the line is
+ * split between the cells the line passes through, so that a prefix sum
+ * along the row gives the fraction of each pixel inside the line.
+ */
+static void accumulate_line(CoverageBuffer *cov, float x0, float y0, float x1, float y1, float dir)
+{
+    float dxdy = (x1 - x0) / (y1 - y0);
+    float x = x0;
+    float x_lo = x0 < x1 ? x0 : x1;
+    float x_hi = x0 < x1 ? x1 : x0;
+    int y_start = (int)y0;
+    int y_end = (int)ceilf(y1);
+    if (y_end > cov->height)
+    {
+        y_end = cov->height;
+    }
+
+    for (int y = y_start; y < y_end; y++)
+    {
+        float *row = cov->cells + (size_t)y * cov->stride;
+        float dy = fminf((float)(y + 1), y1) - fmaxf((float)y, y0);
+        float d = dy * dir;
+
+        // Keep rounding drift from stepping outside the line's own x range
+        float x_next = x + dxdy * dy;
+        x_next = x_next < x_lo ? x_lo : (x_next > x_hi ? x_hi : x_next);
+
+        float xa = x < x_next ? x : x_next;
+        float xb = x < x_next ? x_next : x;
+        float xa_floor = floorf(xa);
+        int xa_i = (int)xa_floor;
+        int xb_i = (int)ceilf(xb);
+
+        if (xb_i <= xa_i + 1)
+        {
+            // The line stays within one pixel column on this row
+            float xm = 0.5f * (x + x_next) - xa_floor;
+            row[xa_i] += d - d * xm;
+            row[xa_i + 1] += d * xm;
+        }
+        else
+        {
+            // Spread the trapezoid over every column the line crosses
+            float s = 1.0f / (xb - xa);
+            float xa_f = xa - xa_floor;
+            float a0 = 0.5f * s * (1.0f - xa_f) * (1.0f - xa_f);
+            float xb_f = xb - xb_i + 1.0f;
+            float am = 0.5f * s * xb_f * xb_f;
+
+            row[xa_i] += d * a0;
+            if (xb_i == xa_i + 2)
+            {
+                row[xa_i + 1] += d * (1.0f - a0 - am);
+            }
+            else
+            {
+                float a1 = s * (1.5f - xa_f);
+                row[xa_i + 1] += d * (a1 - a0);
+                for (int xi = xa_i + 2; xi < xb_i - 1; xi++)
+                {
+                    row[xi] += d * s;
+                }
+                float a2 = a1 + (xb_i - xa_i - 3) * s;
+                row[xb_i - 1] += d * (1.0f - a2 - am);
+            }
+            row[xb_i] += d * am;
+        }
+
+        x = x_next;
+    }
+}
+
+/* Clip a y-ordered line against the right edge, then accumulate it
+ * Anything at or beyond x = width cannot affect visible pixels
+ */
+static void clip_right(CoverageBuffer *cov, float x0, float y0, float x1, float y1, float dir)
+{
+    float w = (float)cov->width;
+
+    if ((x0 < w && x1 > w) || (x0 > w && x1 < w))
+    {
+        float ym = y0 + (w - x0) * (y1 - y0) / (x1 - x0);
+        clip_right(cov, x0, y0, w, ym, dir);
+        clip_right(cov, w, ym, x1, y1, dir);
+        return;
+    }
+
+    if (x0 >= w && x1 >= w)
+    {
+        return;
+    }
+    if (y1 > y0)
+    {
+        accumulate_line(cov, x0, y0, x1, y1, dir);
+    }
+}
+
+/* Add a line, clipping it to the buffer */
+void coverage_add_line(CoverageBuffer *cov, float x0, float y0, float x1, float y1, float winding)
+{
+    if (y0 == y1)
+    {
+        return;
+    }
+
+    // Always accumulate downwards; the direction becomes the sign
+    float dir = winding;
+    if (y0 > y1)
+    {
+        float t;
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+        dir = -dir;
+    }
+
+    float h = (float)cov->height;
+    if (y1 <= 0 || y0 >= h)
+    {
+        return;
+    }
+
+    float dxdy = (x1 - x0) / (y1 - y0);
+    if (y0 < 0)
+    {
+        x0 -= y0 * dxdy;
+        y0 = 0;
+    }
+    if (y1 > h)
+    {
+        x1 -= (y1 - h) * dxdy;
+        y1 = h;
+    }
+
+    // Split where the line crosses x = 0; the left part is folded onto column 0
+    if ((x0 < 0 && x1 > 0) || (x0 > 0 && x1 < 0))
+    {
+        float ym = y0 + (0 - x0) * (y1 - y0) / (x1 - x0);
+        if (x0 < 0)
+        {
+            clip_right(cov, 0, y0, 0, ym, dir);
+            clip_right(cov, 0, ym, x1, y1, dir);
+        }
+        else
+        {
+            clip_right(cov, x0, y0, 0, ym, dir);
+            clip_right(cov, 0, ym, 0, y1, dir);
+        }
+        return;
+    }
+
+    if (x0 <= 0 && x1 <= 0)
+    {
+        x0 = x1 = 0;
+    }
+    clip_right(cov, x0, y0, x1, y1, dir);
+}
+
+/* Prefix-sum one row of cells into clamped 8-bit coverage, starting from
+ * and returning the running sum in carry
+ */
+void coverage_resolve_row_carry(CoverageBuffer *cov, int row, uint8_t *alpha, float *carry)
+{
+    float *cells = cov->cells + (size_t)row * cov->stride;
+    int count = cov->width;
+    int i = 0;
+    float acc = *carry;
+
+#if COVERAGE_SSE2
+    __m128 offset = _mm_set1_ps(acc);
+    __m128 zero = _mm_setzero_ps();
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 scale = _mm_set1_ps(255.0f);
+    __m128 half = _mm_set1_ps(0.5f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        // In-register inclusive scan of four cells, then add the carry
+        __m128 x = _mm_loadu_ps(cells + i);
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 4)));
+        x = _mm_add_ps(x, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(x), 8)));
+        x = _mm_add_ps(x, offset);
+        _mm_storeu_ps(cells + i, zero);
+
+        __m128 y = _mm_min_ps(_mm_max_ps(x, zero), one);
+        __m128i v = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(y, scale), half));
+        v = _mm_packs_epi32(v, v);
+        v = _mm_packus_epi16(v, v);
+        uint32_t packed = (uint32_t)_mm_cvtsi128_si32(v);
+        memcpy(alpha + i, &packed, 4);
+
+        offset = _mm_shuffle_ps(x, x, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+    acc = _mm_cvtss_f32(offset);
+#elif COVERAGE_NEON
+    float32x4_t offset = vdupq_n_f32(acc);
+    float32x4_t zero = vdupq_n_f32(0.0f);
+    float32x4_t one = vdupq_n_f32(1.0f);
+    float32x4_t scale = vdupq_n_f32(255.0f);
+    float32x4_t half = vdupq_n_f32(0.5f);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        // In-register inclusive scan of four cells, then add the carry
+        float32x4_t x = vld1q_f32(cells + i);
+        x = vaddq_f32(x, vextq_f32(zero, x, 3));
+        x = vaddq_f32(x, vextq_f32(zero, x, 2));
+        x = vaddq_f32(x, offset);
+        vst1q_f32(cells + i, zero);
+
+        float32x4_t y = vminq_f32(vmaxq_f32(x, zero), one);
+        uint32x4_t v = vcvtq_u32_f32(vaddq_f32(vmulq_f32(y, scale), half));
+        uint16x4_t narrow = vmovn_u32(v);
+        uint8x8_t bytes = vmovn_u16(vcombine_u16(narrow, narrow));
+        uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+        memcpy(alpha + i, &packed, 4);
+
+        offset = vdupq_n_f32(vgetq_lane_f32(x, 3));
+    }
+    acc = vgetq_lane_f32(offset, 0);
+#endif
+
+    for (; i < count; i++)
+    {
+        acc += cells[i];
+        cells[i] = 0.0f;
+        alpha[i] = coverage_alpha(acc);
+    }
+
+    // Fold in and clear the spill cells past the last column
+    for (; i < cov->stride; i++)
+    {
+        acc += cells[i];
+        cells[i] = 0.0f;
+    }
+    *carry = acc;
+}
+
+/* Prefix-sum one row of cells into clamped 8-bit coverage */
+void coverage_resolve_row(CoverageBuffer *cov, int row, uint8_t *alpha)
+{
+    float carry = 0.0f;
+    coverage_resolve_row_carry(cov, row, alpha, &carry);
+}
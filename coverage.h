@@ -0,0 +1,60 @@
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <stdint.h>
+
+/* Signed-area accumulation buffer for anti-aliased rasterization
+ * Each line adds the signed area it sweeps to the cells it touches; a
+ * running sum along each row then yields the exact coverage of every pixel.
+ * Cost is proportional to edge length plus pixel count, independent of
+ * how many edges cross a row.
+ * cells: Accumulated signed area, stride floats per row
+ * width: Number of pixel columns covered
+ * height: Number of pixel rows covered
+ * stride: Floats per row (room for the spill cell past the last column)
+ */
+typedef struct {
+    float *cells;
+    int width;
+    int height;
+    int stride;
+} CoverageBuffer;
+
+/* Allocate a zeroed buffer of width x height pixels
+ * Returns: 0 on success, -1 on allocation failure
+ */
+int coverage_init(CoverageBuffer *cov, int width, int height);
+
+/* Free the cells of a buffer */
+void coverage_free(CoverageBuffer *cov);
+
+/* Accumulate a line in buffer coordinates
+ * winding: +1 or -1 scales the contribution; paths whose insides should
+ *          count positive must pass the sign matching their orientation
+ * Parts above, below or right of the buffer are dropped; parts left of it
+ * are folded onto column 0 so the row sums stay correct.
+ */
+void coverage_add_line(CoverageBuffer *cov, float x0, float y0, float x1, float y1, float winding);
+
+/* Resolve one row into 8-bit coverage and reset its cells to zero
+ * Runs a vectorized prefix sum (SSE2 or NEON, scalar elsewhere) and clamps
+ * the winding-weighted area to [0, 1].
+ * alpha: Output, width bytes
+ */
+void coverage_resolve_row(CoverageBuffer *cov, int row, uint8_t *alpha);
+
+/* Resolve one row as coverage_resolve_row does, for a buffer that is one
+ * piece of a wider row
+ * carry: Running sum entering column 0; on return, the sum leaving the
+ *        last cell, to carry into the buffer to the right
+ */
+void coverage_resolve_row_carry(CoverageBuffer *cov, int row, uint8_t *alpha, float *carry);
+
+/* 8-bit coverage of a winding-weighted area sum, clamped to [0, 1] */
+static inline uint8_t coverage_alpha(float acc)
+{
+    float y = acc < 0.0f ? 0.0f : (acc > 1.0f ? 1.0f : acc);
+    return (uint8_t)(y * 255.0f + 0.5f);
+}
+
+#endif
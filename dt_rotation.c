@@ -1,78 +1,366 @@
+#define _GNU_SOURCE
 #include <stdio.h>
+#include <stdint.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <dirent.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
 #include "dt_rotation.h"
 
 /* Path to device tree directory */
 #define DEVICE_TREE_PATH "/proc/device-tree"
 #define MAX_PATH_LEN 1024
 
-/* Internal function to search directory recursively */
-static int search_rotation_in_dir(const char *dir_path) {
-    DIR *dir;
-    struct dirent *entry;
-    char full_path[MAX_PATH_LEN];
-    unsigned char rotation_bytes[4];
-    int rotation = 0;
-    FILE *fp;
-
-    dir = opendir(dir_path);
-    if (!dir) {
+/* Deepest node visited by the fallback walk; panels sit a few levels down */
+#define MAX_WALK_DEPTH 8
+
+/* getdents64 buffer per open directory, kept small as it lives on the stack */
+#define DIRENT_BUF_SIZE 2048
+
+/* Largest alias or compatible property read */
+#define MAX_PROPERTY_LEN 256
+
+/* Directory entry as returned by getdents64 */
+struct linux_dirent64 {
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+/* Buffered getdents64 reader over one directory fd */
+typedef struct {
+    int fd;
+    long length;
+    long pos;
+    char buf[DIRENT_BUF_SIZE];
+} DirReader;
+
+/* A rotation property and the node path it was read from */
+typedef struct {
+    int found;
+    int rotation;
+    char path[MAX_PATH_LEN];
+} RotationMatch;
+
+/* Alias and __symbols__ label names that usually point at the display */
+static const char *const display_aliases[] = {
+    "display", "display0", "panel", "panel0", "lcd", "lcd0", "screen", NULL
+};
+
+/* Node name prefixes and compatible substrings marking a display node */
+static const char *const display_names[] = {
+    "panel", "display", "lcd", "framebuffer", "screen", NULL
+};
+
+/* Subtrees that never describe a display, skipped by the walk */
+static const char *const pruned_nodes[] = {
+    "cpus", "memory", "reserved-memory", "aliases", "chosen", "clocks",
+    "opp-table", "thermal-zones", "__symbols__", "__overrides__",
+    "__fixups__", "__local_fixups__", NULL
+};
+
+/* Whether name starts with any prefix in list */
+static int has_prefix(const char *name, const char *const *list) {
+    for (int i = 0; list[i]; i++) {
+        if (strncmp(name, list[i], strlen(list[i])) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Read a property file below dirfd with a single pread
+ * Returns: bytes read or -1 if the property does not exist
+ */
+static ssize_t read_property(int dirfd, const char *name, void *buf, size_t size) {
+    int fd = openat(dirfd, name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    ssize_t length = pread(fd, buf, size, 0);
+    close(fd);
+    return length;
+}
+
+/* Convert a 4-byte big-endian cell to degrees (0, 90, 180, or 270) */
+static int parse_rotation(const unsigned char *bytes) {
+    int rotation = (bytes[0] << 24) | (bytes[1] << 16) | (bytes[2] << 8) | bytes[3];
+
+    /* Normalize rotation to 90-degree increments */
+    rotation = rotation % 360;
+    if (rotation < 0) {
+        rotation += 360;
+    }
+    return (rotation / 90) * 90;
+}
+
+/* Read the rotation property of the node open at dirfd
+ * Returns: 0 on success, -1 if the node has no valid rotation
+ */
+static int read_rotation(int dirfd, int *rotation) {
+    unsigned char bytes[4];
+    if (read_property(dirfd, "rotation", bytes, sizeof(bytes)) != 4) {
+        return -1;
+    }
+    *rotation = parse_rotation(bytes);
+    return 0;
+}
+
+/* Look up the rotation of the node at path (relative to the tree root) */
+static int node_rotation(int root, const char *path, RotationMatch *match) {
+    while (*path == '/') {
+        path++;
+    }
+
+    int fd = openat(root, *path ? path : ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    int status = read_rotation(fd, &match->rotation);
+    close(fd);
+
+    if (status == 0) {
+        match->found = 1;
+        snprintf(match->path, sizeof(match->path), "%s", path);
+    }
+    return status;
+}
+
+/* Return the next directory entry, refilling from getdents64 as needed */
+static struct linux_dirent64 *next_entry(DirReader *reader) {
+    if (reader->pos >= reader->length) {
+        reader->length = syscall(SYS_getdents64, reader->fd, reader->buf, sizeof(reader->buf));
+        reader->pos = 0;
+        if (reader->length <= 0) {
+            return NULL;
+        }
+    }
+    struct linux_dirent64 *entry = (struct linux_dirent64 *)(reader->buf + reader->pos);
+    reader->pos += entry->d_reclen;
+    return entry;
+}
+
+/* Whether an entry is a subnode, asking the filesystem if getdents could not say */
+static int is_node(int dirfd, const struct linux_dirent64 *entry) {
+    if (entry->d_type != DT_UNKNOWN) {
+        return entry->d_type == DT_DIR;
+    }
+    struct stat st;
+    return fstatat(dirfd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(st.st_mode);
+}
+
+/* Whether the node open at dirfd is a display by name or compatible string */
+static int is_display_node(int dirfd, const char *name) {
+    if (has_prefix(name, display_names)) {
+        return 1;
+    }
+
+    char compatible[MAX_PROPERTY_LEN + 1];
+    ssize_t length = read_property(dirfd, "compatible", compatible, MAX_PROPERTY_LEN);
+    if (length <= 0) {
         return 0;
     }
+    compatible[length] = '\0';
+
+    /* compatible is a list of NUL separated strings */
+    for (const char *s = compatible; s < compatible + length; s += strlen(s) + 1) {
+        for (int i = 0; display_names[i]; i++) {
+            if (strstr(s, display_names[i])) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Try the simple-framebuffer nodes firmware places under /chosen */
+static int lookup_chosen(int root, RotationMatch *match) {
+    DirReader reader;
+    reader.fd = openat(root, "chosen", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    reader.length = reader.pos = 0;
+    if (reader.fd == -1) {
+        return -1;
+    }
 
-    while ((entry = readdir(dir)) != NULL) {
-        if (entry->d_name[0] == '.') {
+    char path[MAX_PATH_LEN];
+    struct linux_dirent64 *entry;
+    int status = -1;
+    while (status != 0 && (entry = next_entry(&reader)) != NULL) {
+        if (strncmp(entry->d_name, "framebuffer", 11) == 0 && is_node(reader.fd, entry)) {
+            snprintf(path, sizeof(path), "chosen/%s", entry->d_name);
+            status = node_rotation(root, path, match);
+        }
+    }
+
+    close(reader.fd);
+    return status;
+}
+
+/* Follow display aliases in a node of path properties (/aliases or /__symbols__) */
+static int lookup_aliases(int root, const char *table, RotationMatch *match) {
+    int fd = openat(root, table, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+
+    char target[MAX_PROPERTY_LEN + 1];
+    int status = -1;
+    for (int i = 0; status != 0 && display_aliases[i]; i++) {
+        ssize_t length = read_property(fd, display_aliases[i], target, MAX_PROPERTY_LEN);
+        if (length > 0) {
+            target[length] = '\0';
+            status = node_rotation(root, target, match);
+        }
+    }
+
+    close(fd);
+    return status;
+}
+
+/* Depth-limited walk below the node open at dirfd
+ * The first rotation on a display node wins; the first rotation on any other
+ * node is kept in fallback in case no display node has one.
+ * path holds the node path relative to the root, length its current length.
+ * Returns: 0 once a display node matched, -1 to keep searching
+ */
+static int walk_nodes(int dirfd, const char *name, char *path, size_t length, int depth,
+                      RotationMatch *match, RotationMatch *fallback) {
+    int rotation;
+    if (read_rotation(dirfd, &rotation) == 0) {
+        RotationMatch *target = is_display_node(dirfd, name) ? match : fallback;
+        if (!target->found) {
+            target->found = 1;
+            target->rotation = rotation;
+            snprintf(target->path, sizeof(target->path), "%s", path);
+        }
+        if (match->found) {
+            return 0;
+        }
+    }
+
+    if (depth >= MAX_WALK_DEPTH) {
+        return -1;
+    }
+
+    DirReader reader;
+    reader.fd = dirfd;
+    reader.length = reader.pos = 0;
+
+    struct linux_dirent64 *entry;
+    while ((entry = next_entry(&reader)) != NULL) {
+        if (entry->d_name[0] == '.' || has_prefix(entry->d_name, pruned_nodes) ||
+            !is_node(dirfd, entry)) {
             continue;
         }
 
-        snprintf(full_path, sizeof(full_path), "%s/%s", dir_path, entry->d_name);
+        int written = snprintf(path + length, MAX_PATH_LEN - length, "%s%s",
+                               length ? "/" : "", entry->d_name);
+        if (written < 0 || (size_t)written >= MAX_PATH_LEN - length) {
+            continue;
+        }
 
-        if (entry->d_type == DT_DIR) {
-            /* Recursively search subdirectory */
-            rotation = search_rotation_in_dir(full_path);
-            if (rotation != 0) {
-                closedir(dir);
-                return rotation;
-            }
-        } else if (strcmp(entry->d_name, "rotation") == 0) {
-            fp = fopen(full_path, "r");
-            if (fp) {
-                if (fread(rotation_bytes, 1, 4, fp) == 4) {
-                    /* Convert big-endian bytes to integer */
-                    rotation = (rotation_bytes[0] << 24) |
-                             (rotation_bytes[1] << 16) |
-                             (rotation_bytes[2] << 8) |
-                             (rotation_bytes[3]);
-
-                    /* Normalize rotation to 90-degree increments */
-                    rotation = rotation % 360;
-                    if (rotation < 0) {
-                        rotation += 360;
-                    }
-                    rotation = (rotation / 90) * 90;
-
-                    fclose(fp);
-                    closedir(dir);
-                    return rotation;
-                }
-                fclose(fp);
-            }
+        int fd = openat(dirfd, entry->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1) {
+            continue;
+        }
+        int status = walk_nodes(fd, entry->d_name, path, length + written, depth + 1,
+                                match, fallback);
+        close(fd);
+        path[length] = '\0';
+
+        if (status == 0) {
+            return 0;
         }
     }
+    return -1;
+}
 
-    closedir(dir);
+/* Read the rotation through the property path stored in the hint file
+ * Returns: 0 on success, -1 if the hint is missing or stale
+ */
+static int read_hint(const char *hint_path, int *rotation) {
+    char path[MAX_PATH_LEN];
+    ssize_t length = read_property(AT_FDCWD, hint_path, path, sizeof(path) - 1);
+    if (length <= 0) {
+        return -1;
+    }
+    path[length] = '\0';
+    path[strcspn(path, "\n")] = '\0';
+
+    unsigned char bytes[4];
+    if (read_property(AT_FDCWD, path, bytes, sizeof(bytes)) != 4) {
+        return -1;
+    }
+    *rotation = parse_rotation(bytes);
     return 0;
 }
 
+/* Store the rotation property path for the next boot, ignoring failures
+ * (the root filesystem may still be read-only)
+ */
+static void write_hint(const char *hint_path, const char *node) {
+    char line[MAX_PATH_LEN + 32];
+    int length = snprintf(line, sizeof(line), "%s%s%s/rotation\n", DEVICE_TREE_PATH,
+                          *node ? "/" : "", node);
+    if (length < 0 || (size_t)length >= sizeof(line)) {
+        return;
+    }
+
+    int fd = open(hint_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return;
+    }
+    ssize_t written = write(fd, line, length);
+    (void)written;
+    close(fd);
+}
+
 /* Get display rotation from device tree
  * Returns: rotation angle in degrees (0, 90, 180, or 270)
  *
- * This function recursively traverses the device tree directory
- * structure looking for a file named "rotation". When found, it
- * reads a 4-byte big-endian integer value and normalizes it to
- * 0, 90, 180, or 270 degrees.
+ * The display node is looked for in order: the hint file, simple-framebuffer
+ * nodes under /chosen, display aliases in /aliases and /__symbols__, then a
+ * depth-limited walk that skips subtrees which never hold a display. The walk
+ * prefers a rotation on a node named or compatible like a panel, falling back
+ * to the first rotation seen anywhere. Whatever the lookup finds is written
+ * to the hint file.
  */
+int get_display_rotation_cached(const char *hint_path) {
+    int rotation;
+    if (hint_path && read_hint(hint_path, &rotation) == 0) {
+        return rotation;
+    }
+
+    int root = open(DEVICE_TREE_PATH, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (root == -1) {
+        return 0;
+    }
+
+    RotationMatch match = {0};
+    RotationMatch fallback = {0};
+    if (lookup_chosen(root, &match) != 0 &&
+        lookup_aliases(root, "aliases", &match) != 0 &&
+        lookup_aliases(root, "__symbols__", &match) != 0) {
+        char path[MAX_PATH_LEN] = "";
+        walk_nodes(root, "", path, 0, 0, &match, &fallback);
+    }
+    close(root);
+
+    RotationMatch *result = match.found ? &match : &fallback;
+    if (!result->found) {
+        return 0;
+    }
+    if (hint_path) {
+        write_hint(hint_path, result->path);
+    }
+    return result->rotation;
+}
+
+/* Get display rotation from device tree without a hint file */
 int get_display_rotation(void) {
-    return search_rotation_in_dir(DEVICE_TREE_PATH);
+    return get_display_rotation_cached(NULL);
 }
@@ -2,9 +2,17 @@
 #define DT_ROTATION_H
 
 /* Get display rotation from device tree
- * Recursively searches /proc/device-tree for rotation property
+ * Looks for the display node through /chosen, aliases and panel names before
+ * falling back to a bounded walk of /proc/device-tree
  * Returns: rotation angle in degrees (0, 90, 180, or 270)
  */
 int get_display_rotation(void);
 
+/* Get display rotation, trying the property path stored in hint_path first
+ * A successful lookup rewrites the hint so later boots read the property
+ * directly. hint_path may be NULL.
+ * Returns: rotation angle in degrees (0, 90, 180, or 270)
+ */
+int get_display_rotation_cached(const char *hint_path);
+
 #endif
@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "fb_headless.h"
+
+/* Largest accepted width or height, keeping every size computation in range */
+#define MAX_DIMENSION 32768
+
+/* Backend prefixes, in the order they are tried */
+#define MEM_PREFIX "mem:"
+#define MEMFD_PREFIX "memfd:"
+#define FILE_PREFIX "file:"
+
+/* Showing another page needs nothing more than the new yoffset */
+static int headless_pan(Framebuffer *fb, uint32_t yoffset)
+{
+    (void)fb;
+    (void)yoffset;
+    return 0;
+}
+
+/* Unmap the pixels and close the backing file, if any */
+static void headless_release(Framebuffer *fb)
+{
+    if (fb->buffer != MAP_FAILED && fb->buffer != NULL)
+    {
+        munmap(fb->buffer, fb->screensize);
+    }
+    if (fb->fd >= 0)
+    {
+        close(fb->fd);
+    }
+}
+
+static const FramebufferOps mem_ops = {
+    .name = "mem",
+    .pan = headless_pan,
+    .release = headless_release,
+};
+
+static const FramebufferOps memfd_ops = {
+    .name = "memfd",
+    .pan = headless_pan,
+    .release = headless_release,
+};
+
+static const FramebufferOps file_ops = {
+    .name = "file",
+    .pan = headless_pan,
+    .release = headless_release,
+};
+
+/* Parse an unsigned decimal number, advancing *pos past it
+ * Returns: 0 on success, -1 if no digits were found
+ */
+static int parse_number(const char **pos, uint32_t *value)
+{
+    char *end;
+    unsigned long number = strtoul(*pos, &end, 10);
+    if (end == *pos || number > UINT32_MAX)
+    {
+        return -1;
+    }
+    *value = number;
+    *pos = end;
+    return 0;
+}
+
+/* Parse an OFF/LEN channel bitfield */
+static int parse_bitfield(const char **pos, struct fb_bitfield *field)
+{
+    if (parse_number(pos, &field->offset) != 0 || **pos != '/')
+    {
+        return -1;
+    }
+    (*pos)++;
+    return parse_number(pos, &field->length);
+}
+
+/* Parse WIDTHxHEIGHT[xBPP][,option...] into a mode
+ * Returns: 0 on success, -1 on a malformed or unsupported mode
+ */
+static int parse_mode(const char *pos, struct fb_var_screeninfo *vinfo,
+                      struct fb_fix_screeninfo *finfo)
+{
+    uint32_t vyres = 0;
+    uint32_t stride = 0;
+
+    memset(vinfo, 0, sizeof(*vinfo));
+    memset(finfo, 0, sizeof(*finfo));
+    vinfo->bits_per_pixel = 32;
+
+    if (parse_number(&pos, &vinfo->xres) != 0 || *pos++ != 'x' ||
+        parse_number(&pos, &vinfo->yres) != 0)
+    {
+        return -1;
+    }
+    if (*pos == 'x' && (pos++, parse_number(&pos, &vinfo->bits_per_pixel) != 0))
+    {
+        return -1;
+    }
+
+    while (*pos == ',')
+    {
+        const char *name = pos + 1;
+        const char *value = strchr(name, '=');
+        if (!value)
+        {
+            return -1;
+        }
+        size_t length = value - name;
+        pos = value + 1;
+
+        int status;
+        if (length == 6 && strncmp(name, "stride", length) == 0)
+            status = parse_number(&pos, &stride);
+        else if (length == 7 && strncmp(name, "xoffset", length) == 0)
+            status = parse_number(&pos, &vinfo->xoffset);
+        else if (length == 7 && strncmp(name, "yoffset", length) == 0)
+            status = parse_number(&pos, &vinfo->yoffset);
+        else if (length == 5 && strncmp(name, "vyres", length) == 0)
+            status = parse_number(&pos, &vyres);
+        else if (length == 3 && strncmp(name, "red", length) == 0)
+            status = parse_bitfield(&pos, &vinfo->red);
+        else if (length == 5 && strncmp(name, "green", length) == 0)
+            status = parse_bitfield(&pos, &vinfo->green);
+        else if (length == 4 && strncmp(name, "blue", length) == 0)
+            status = parse_bitfield(&pos, &vinfo->blue);
+        else
+            status = -1;
+
+        if (status != 0)
+        {
+            return -1;
+        }
+    }
+
+    if (*pos != '\0' || vinfo->xres == 0 || vinfo->yres == 0 ||
+        vinfo->xres + vinfo->xoffset > MAX_DIMENSION ||
+        vinfo->yres + vinfo->yoffset > MAX_DIMENSION || vyres > 2 * MAX_DIMENSION ||
+        (vinfo->bits_per_pixel != 16 && vinfo->bits_per_pixel != 24 &&
+         vinfo->bits_per_pixel != 32))
+    {
+        return -1;
+    }
+
+    vinfo->xres_virtual = vinfo->xres + vinfo->xoffset;
+    vinfo->yres_virtual = vinfo->yres + vinfo->yoffset;
+    if (vyres > vinfo->yres_virtual)
+    {
+        vinfo->yres_virtual = vyres;
+    }
+
+    uint32_t min_stride = vinfo->xres_virtual * (vinfo->bits_per_pixel / 8);
+    if (stride == 0)
+    {
+        stride = min_stride;
+    }
+    if (stride < min_stride || stride > 8 * MAX_DIMENSION)
+    {
+        return -1;
+    }
+
+    snprintf(finfo->id, sizeof(finfo->id), "headless");
+    finfo->type = FB_TYPE_PACKED_PIXELS;
+    finfo->visual = FB_VISUAL_TRUECOLOR;
+    finfo->line_length = stride;
+    finfo->ypanstep = 1;
+    finfo->smem_len = stride * vinfo->yres_virtual;
+
+    return 0;
+}
+
+/* Map size bytes of fd shared, or anonymous memory when fd is -1
+ * Returns: Mapping or NULL on failure
+ */
+static uint8_t *map_pixels(int fd, size_t size)
+{
+    void *map;
+    if (fd >= 0)
+    {
+        if (ftruncate(fd, size) == -1)
+        {
+            return NULL;
+        }
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    else
+    {
+        map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    return map == MAP_FAILED ? NULL : map;
+}
+
+/* Recognize a headless backend prefix */
+bool fb_headless_spec(const char *spec)
+{
+    return strncmp(spec, MEM_PREFIX, strlen(MEM_PREFIX)) == 0 ||
+           strncmp(spec, MEMFD_PREFIX, strlen(MEMFD_PREFIX)) == 0 ||
+           strncmp(spec, FILE_PREFIX, strlen(FILE_PREFIX)) == 0;
+}
+
+/* Create the backing store for a spec and set up the framebuffer on it */
+Framebuffer *fb_headless_open(const char *spec)
+{
+    Framebuffer *fb = calloc(1, sizeof(Framebuffer));
+    if (!fb)
+    {
+        return NULL;
+    }
+    fb->fd = -1;
+
+    const char *mode;
+    if (strncmp(spec, MEMFD_PREFIX, strlen(MEMFD_PREFIX)) == 0)
+    {
+        fb->ops = &memfd_ops;
+        mode = spec + strlen(MEMFD_PREFIX);
+    }
+    else if (strncmp(spec, FILE_PREFIX, strlen(FILE_PREFIX)) == 0)
+    {
+        // The mode follows the last colon, so the path may contain colons
+        fb->ops = &file_ops;
+        mode = strrchr(spec, ':') + 1;
+    }
+    else
+    {
+        fb->ops = &mem_ops;
+        mode = spec + strlen(MEM_PREFIX);
+    }
+
+    if (parse_mode(mode, &fb->vinfo, &fb->finfo) != 0)
+    {
+        fprintf(stderr, "Invalid headless framebuffer spec: %s\n", spec);
+        free(fb);
+        return NULL;
+    }
+
+    if (fb->ops == &memfd_ops)
+    {
+        fb->fd = memfd_create("mess-splash", MFD_CLOEXEC);
+    }
+    else if (fb->ops == &file_ops)
+    {
+        const char *path = spec + strlen(FILE_PREFIX);
+        size_t length = mode - 1 - path;
+        char *name = strndup(path, length);
+        if (name && length > 0)
+        {
+            fb->fd = open(name, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        }
+        free(name);
+    }
+
+    if (fb->ops != &mem_ops && fb->fd == -1)
+    {
+        free(fb);
+        return NULL;
+    }
+
+    fb->screensize = fb->finfo.smem_len;
+    fb->buffer = map_pixels(fb->fd, fb->screensize);
+    if (!fb->buffer || fb_setup(fb) != 0)
+    {
+        headless_release(fb);
+        free(fb);
+        return NULL;
+    }
+
+    return fb;
+}
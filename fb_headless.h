@@ -0,0 +1,35 @@
+#ifndef FB_HEADLESS_H
+#define FB_HEADLESS_H
+
+#include <stdbool.h>
+#include "fbsplash.h"
+
+/* Headless framebuffer backends
+ * Render targets with no display behind them, for development machines and
+ * build hosts. A spec names the backend followed by the mode:
+ *
+ *   mem:WIDTHxHEIGHT[xBPP][,option...]           heap memory
+ *   memfd:WIDTHxHEIGHT[xBPP][,option...]         anonymous memfd mapping
+ *   file:PATH:WIDTHxHEIGHT[xBPP][,option...]     shared mapping of PATH
+ *
+ * BPP defaults to 32. Options:
+ *   stride=BYTES        line_length (default: xres_virtual * bytes per pixel)
+ *   xoffset=N           Visible area offset into the virtual width
+ *   yoffset=N           Visible area offset into the virtual height
+ *   vyres=N             yres_virtual, 2 * HEIGHT or more enables page flipping
+ *   red=OFF/LEN         Channel bitfields, likewise green= and blue=
+ *                       (default: the usual layout for the depth)
+ *
+ * The file backend leaves the raw pixels of the whole virtual area in PATH.
+ */
+
+/* Whether spec names a headless backend rather than a device path */
+bool fb_headless_spec(const char *spec);
+
+/* Create a headless framebuffer from a spec
+ * Returns: Pointer to initialized Framebuffer structure or NULL on a bad
+ *          spec or allocation failure
+ */
+Framebuffer *fb_headless_open(const char *spec);
+
+#endif
@@ -6,6 +6,206 @@
 #include <sys/mman.h>
 #include <sys/ioctl.h>
 #include "fbsplash.h"
+#include "fb_headless.h"
+#include "span_fill.h"
+#include "transform.h"
+
+/* Bytes per pixel of the current mode */
+static inline uint32_t bytes_per_pixel(const Framebuffer *fb)
+{
+    return fb->vinfo.bits_per_pixel / 8;
+}
+
+/* Address of the first byte of a page in the mapped buffer
+ * In single-buffer mode the only page is wherever the display is panned to
+ */
+static uint8_t *page_origin(Framebuffer *fb, uint32_t page)
+{
+    if (fb->num_pages == 1)
+    {
+        return fb->buffer + fb->vinfo.yoffset * fb->finfo.line_length;
+    }
+    return fb->buffer + page * fb->page_size;
+}
+
+/* Point the render target at the shadow or the page being drawn */
+static void update_draw_target(Framebuffer *fb)
+{
+    fb->draw = fb->shadow ? fb->shadow : page_origin(fb, fb->back_page);
+}
+
+/* Some drivers leave line_length unset */
+static void default_line_length(const struct fb_var_screeninfo *vinfo,
+                                struct fb_fix_screeninfo *finfo)
+{
+    if (finfo->line_length == 0)
+    {
+        finfo->line_length = vinfo->xres_virtual * (vinfo->bits_per_pixel / 8);
+    }
+}
+
+/* Bytes of the virtual framebuffer of a mode, limited to video memory */
+static size_t mapping_size(const struct fb_var_screeninfo *vinfo,
+                           const struct fb_fix_screeninfo *finfo)
+{
+    size_t size = (size_t)finfo->line_length * vinfo->yres_virtual;
+    if (finfo->smem_len && size > finfo->smem_len)
+    {
+        size = finfo->smem_len;
+    }
+    return size;
+}
+
+/* Whether the visible page of a mode lies entirely inside a mapping of size bytes */
+static bool page_fits(const struct fb_var_screeninfo *vinfo, const struct fb_fix_screeninfo *finfo,
+                      uint32_t bytes, size_t size)
+{
+    return (size_t)(vinfo->xoffset + vinfo->xres) * bytes <= finfo->line_length &&
+           (size_t)(vinfo->yoffset + vinfo->yres) * finfo->line_length <= size;
+}
+
+/* Map the whole virtual framebuffer of the fbdev device
+ * Returns: 0 on success, -1 if the mapping fails
+ */
+static int map_framebuffer(Framebuffer *fb)
+{
+    default_line_length(&fb->vinfo, &fb->finfo);
+    fb->screensize = mapping_size(&fb->vinfo, &fb->finfo);
+
+    fb->buffer = mmap(NULL, fb->screensize, PROT_READ | PROT_WRITE, MAP_SHARED, fb->fd, 0);
+    if (fb->buffer == MAP_FAILED)
+    {
+        fb->buffer = NULL;
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Show the page starting at row yoffset with FBIOPAN_DISPLAY */
+static int fbdev_pan(Framebuffer *fb, uint32_t yoffset)
+{
+    struct fb_var_screeninfo pan = fb->vinfo;
+    pan.yoffset = yoffset;
+    return ioctl(fb->fd, FBIOPAN_DISPLAY, &pan) == -1 ? -1 : 0;
+}
+
+/* Wait for the next vertical blank on the first CRTC */
+static int fbdev_wait_vsync(Framebuffer *fb)
+{
+    uint32_t crtc = 0;
+    return ioctl(fb->fd, FBIO_WAITFORVSYNC, &crtc) == -1 ? -1 : 0;
+}
+
+/* Map the device again for the mode in vinfo and finfo
+ * The old mapping is kept on failure and released only once the new one exists
+ */
+static int fbdev_remap(Framebuffer *fb)
+{
+    uint8_t *old_buffer = fb->buffer;
+    size_t old_size = fb->screensize;
+    if (map_framebuffer(fb) != 0)
+    {
+        fb->buffer = old_buffer;
+        fb->screensize = old_size;
+        return -1;
+    }
+    munmap(old_buffer, old_size);
+    update_draw_target(fb);
+
+    return 0;
+}
+
+/* Ask the driver for rows of virtual height and remap
+ * Accepts the new mode only if the row layout stayed the same
+ */
+static int fbdev_grow_virtual(Framebuffer *fb, uint32_t rows)
+{
+    if (fb->finfo.smem_len < (size_t)rows * fb->finfo.line_length)
+    {
+        return -1;
+    }
+
+    struct fb_var_screeninfo request = fb->vinfo;
+    struct fb_fix_screeninfo fixed;
+    request.yres_virtual = rows;
+    request.yoffset = 0;
+
+    if (ioctl(fb->fd, FBIOPUT_VSCREENINFO, &request) == -1 ||
+        ioctl(fb->fd, FBIOGET_VSCREENINFO, &request) == -1 ||
+        ioctl(fb->fd, FBIOGET_FSCREENINFO, &fixed) == -1 ||
+        request.yres_virtual < rows ||
+        fixed.line_length != fb->finfo.line_length)
+    {
+        ioctl(fb->fd, FBIOGET_VSCREENINFO, &fb->vinfo);
+        return -1;
+    }
+
+    // Remap so the new rows are addressable
+    fb->vinfo = request;
+    fb->finfo = fixed;
+    return fbdev_remap(fb);
+}
+
+/* Read the current mode from the driver */
+static int fbdev_query_mode(Framebuffer *fb, struct fb_var_screeninfo *vinfo,
+                            struct fb_fix_screeninfo *finfo)
+{
+    if (ioctl(fb->fd, FBIOGET_VSCREENINFO, vinfo) == -1 ||
+        ioctl(fb->fd, FBIOGET_FSCREENINFO, finfo) == -1)
+    {
+        return -1;
+    }
+    return 0;
+}
+
+/* Unmap the device memory and close the device */
+static void fbdev_release(Framebuffer *fb)
+{
+    if (fb->buffer != MAP_FAILED && fb->buffer != NULL)
+    {
+        munmap(fb->buffer, fb->screensize);
+    }
+    if (fb->fd >= 0)
+    {
+        close(fb->fd);
+    }
+}
+
+static const FramebufferOps fbdev_ops = {
+    .name = "fbdev",
+    .pan = fbdev_pan,
+    .wait_vsync = fbdev_wait_vsync,
+    .grow_virtual = fbdev_grow_virtual,
+    .query_mode = fbdev_query_mode,
+    .remap = fbdev_remap,
+    .release = fbdev_release,
+};
+
+/* Resolve the pixel format and point drawing at the visible page */
+int fb_setup(Framebuffer *fb)
+{
+    // Resolve the pixel layout and its span writers
+    if (pixel_format_init(&fb->format, &fb->vinfo, false) != 0)
+    {
+        fprintf(stderr, "Unsupported pixel format: %u bpp\n", fb->vinfo.bits_per_pixel);
+        return -1;
+    }
+
+    fb->page_size = (size_t)fb->finfo.line_length * fb->vinfo.yres;
+
+    // The visible page must lie entirely inside the mapping
+    if (!page_fits(&fb->vinfo, &fb->finfo, fb->format.bytes, fb->screensize))
+    {
+        return -1;
+    }
+
+    // Single page, drawn directly until a shadow buffer or page flipping is enabled
+    fb->num_pages = 1;
+    update_draw_target(fb);
+
+    return 0;
+}
 
 /* Initialize the framebuffer device
  * Opens the device, gets screen information, and maps the framebuffer to memory
@@ -18,6 +218,7 @@ Framebuffer *fb_init(const char *fb_device)
     {
         return NULL;
     }
+    fb->ops = &fbdev_ops;
 
     // Open the framebuffer device
     fb->fd = open(fb_device, O_RDWR);
@@ -43,72 +244,599 @@ Framebuffer *fb_init(const char *fb_device)
         return NULL;
     }
 
-    // Calculate total screen size in bytes
-    fb->screensize = fb->vinfo.xres * fb->vinfo.yres * (fb->vinfo.bits_per_pixel / 8);
-
-    // Map framebuffer to memory
-    fb->buffer = mmap(NULL, fb->screensize, PROT_READ | PROT_WRITE, MAP_SHARED, fb->fd, 0);
-
-    if (fb->buffer == MAP_FAILED)
+    // Map framebuffer to memory, including any virtual area beyond the screen
+    if (map_framebuffer(fb) != 0)
     {
         close(fb->fd);
         free(fb);
         return NULL;
     }
 
+    if (fb_setup(fb) != 0)
+    {
+        fbdev_release(fb);
+        free(fb);
+        return NULL;
+    }
+
     return fb;
 }
 
+/* Open an fbdev device or a headless backend, depending on the spec */
+Framebuffer *fb_open(const char *spec)
+{
+    if (fb_headless_spec(spec))
+    {
+        return fb_headless_open(spec);
+    }
+    return fb_init(spec);
+}
+
+/* Reselect the span writers with or without dithering */
+void fb_set_dither(Framebuffer *fb, bool enable)
+{
+    fb->dither = enable;
+    pixel_format_init(&fb->format, &fb->vinfo, enable);
+}
+
+/* Mark a run of pixels on row y as modified
+ * Only tracked while a shadow buffer or page flipping is active
+ */
+static inline void mark_dirty(DirtySpan *rows, int x_start, int x_end, int y)
+{
+    DirtySpan *span = &rows[y];
+    if (x_start < span->x_start)
+    {
+        span->x_start = x_start;
+    }
+    if (x_end > span->x_end)
+    {
+        span->x_end = x_end;
+    }
+}
+
+/* Set every row of a dirty table to empty, or to the full width */
+static void reset_rows(Framebuffer *fb, DirtySpan *rows, bool full)
+{
+    for (uint32_t y = 0; y < fb->vinfo.yres; y++)
+    {
+        rows[y].x_start = full ? 0 : INT32_MAX;
+        rows[y].x_end = full ? (int32_t)fb->vinfo.xres - 1 : -1;
+    }
+}
+
+/* Allocate the dirty, back-stale and front-stale row tables once */
+static int alloc_tracking(Framebuffer *fb)
+{
+    if (fb->dirty)
+    {
+        return 0;
+    }
+
+    DirtySpan *rows = malloc(3 * fb->vinfo.yres * sizeof(DirtySpan));
+    if (!rows)
+    {
+        return -1;
+    }
+
+    fb->dirty = rows;
+    fb->back_stale = rows + fb->vinfo.yres;
+    fb->front_stale = rows + 2 * fb->vinfo.yres;
+    reset_rows(fb, fb->dirty, false);
+    reset_rows(fb, fb->back_stale, false);
+    reset_rows(fb, fb->front_stale, false);
+
+    return 0;
+}
+
+/* Copy the pixels of columns [x_start, x_end] on row y between two page origins */
+static void copy_row_span(Framebuffer *fb, uint8_t *dst, const uint8_t *src,
+                          int x_start, int x_end, uint32_t y)
+{
+    size_t offset = y * fb->finfo.line_length + (x_start + fb->vinfo.xoffset) * bytes_per_pixel(fb);
+    copy_stream(dst + offset, src + offset, (x_end - x_start + 1) * bytes_per_pixel(fb));
+}
+
+/* Enable shadow buffer mode
+ * The shadow mirrors one page of the mapped layout byte for byte, so flushing
+ * is a straight copy at identical offsets
+ */
+int fb_enable_shadow(Framebuffer *fb)
+{
+    if (fb->shadow)
+    {
+        return 0;
+    }
+
+    if (alloc_tracking(fb) != 0)
+    {
+        return -1;
+    }
+
+    void *shadow;
+    if (posix_memalign(&shadow, 64, fb->page_size) != 0)
+    {
+        return -1;
+    }
+
+    memset(shadow, 0, fb->page_size);
+    fb->shadow = shadow;
+    update_draw_target(fb);
+
+    // Neither page matches the fresh shadow yet
+    if (fb->num_pages == 2)
+    {
+        reset_rows(fb, fb->back_stale, true);
+        reset_rows(fb, fb->front_stale, true);
+    }
+
+    return 0;
+}
+
+/* Enable double buffering through the virtual framebuffer
+ * Grows yres_virtual when the driver has memory for a second page but does not
+ * expose it, then renders into whichever page is not on screen.
+ */
+int fb_enable_page_flip(Framebuffer *fb, bool wait_vsync)
+{
+    if (fb->num_pages == 2)
+    {
+        return 0;
+    }
+
+    // Panning must be supported in steps that divide the page height
+    if (!fb->ops->pan || fb->finfo.ypanstep == 0 || fb->vinfo.yres % fb->finfo.ypanstep != 0)
+    {
+        return -1;
+    }
+
+    // Grow the virtual area when the backend has room for a second page
+    if (fb->vinfo.yres_virtual < 2 * fb->vinfo.yres &&
+        (!fb->ops->grow_virtual || fb->ops->grow_virtual(fb, 2 * fb->vinfo.yres) != 0))
+    {
+        return -1;
+    }
+    if (2 * fb->page_size > fb->screensize)
+    {
+        return -1;
+    }
+
+    if (alloc_tracking(fb) != 0)
+    {
+        return -1;
+    }
+
+    uint32_t front = fb->vinfo.yoffset >= fb->vinfo.yres ? 1 : 0;
+    uint8_t *front_origin = page_origin(fb, front);
+
+    fb->num_pages = 2;
+    fb->back_page = 1 - front;
+    fb->wait_vsync = wait_vsync;
+
+    if (fb->shadow)
+    {
+        // Neither page has seen the shadow contents yet
+        reset_rows(fb, fb->back_stale, true);
+        reset_rows(fb, fb->front_stale, true);
+    }
+    else
+    {
+        // Start the back page from what is on screen
+        copy_stream(page_origin(fb, fb->back_page), front_origin, fb->page_size);
+    }
+    update_draw_target(fb);
+
+    return 0;
+}
+
+/* Whether two modes place and encode the visible pixels alike */
+static bool same_layout(const struct fb_var_screeninfo *a, const struct fb_var_screeninfo *b)
+{
+    return a->xres == b->xres && a->yres == b->yres &&
+           a->xres_virtual == b->xres_virtual && a->yres_virtual == b->yres_virtual &&
+           a->xoffset == b->xoffset && a->yoffset == b->yoffset &&
+           a->bits_per_pixel == b->bits_per_pixel && a->grayscale == b->grayscale &&
+           memcmp(&a->red, &b->red, sizeof(a->red)) == 0 &&
+           memcmp(&a->green, &b->green, sizeof(a->green)) == 0 &&
+           memcmp(&a->blue, &b->blue, sizeof(a->blue)) == 0;
+}
+
+/* Re-query the mode and rebuild the page layout for it
+ * A mode that cannot be drawn is refused before anything is changed. The
+ * shadow and the dirty tables are sized by the page, so they are allocated
+ * again, and page flipping restarts from whichever page is on screen.
+ */
+int fb_reload_mode(Framebuffer *fb)
+{
+    if (!fb->ops->query_mode)
+    {
+        return 0;
+    }
+
+    struct fb_var_screeninfo vinfo;
+    struct fb_fix_screeninfo finfo;
+    if (fb->ops->query_mode(fb, &vinfo, &finfo) != 0)
+    {
+        return -1;
+    }
+    default_line_length(&vinfo, &finfo);
+    if (same_layout(&fb->vinfo, &vinfo) && finfo.line_length == fb->finfo.line_length &&
+        finfo.smem_len == fb->finfo.smem_len)
+    {
+        return 0;
+    }
+
+    PixelFormat format;
+    size_t screensize = mapping_size(&vinfo, &finfo);
+    if (pixel_format_init(&format, &vinfo, fb->dither) != 0 ||
+        !page_fits(&vinfo, &finfo, format.bytes, screensize))
+    {
+        return -1;
+    }
+
+    // Remap only when the mapping no longer matches the mode
+    struct fb_var_screeninfo old_vinfo = fb->vinfo;
+    struct fb_fix_screeninfo old_finfo = fb->finfo;
+    bool remap = screensize != fb->screensize || finfo.line_length != fb->finfo.line_length;
+    fb->vinfo = vinfo;
+    fb->finfo = finfo;
+    if (remap && fb->ops->remap(fb) != 0)
+    {
+        fb->vinfo = old_vinfo;
+        fb->finfo = old_finfo;
+        return -1;
+    }
+
+    fb->format = format;
+    fb->page_size = (size_t)finfo.line_length * vinfo.yres;
+
+    // Start over single buffered, then restore the buffering in use
+    bool shadow = fb->shadow != NULL;
+    bool flip = fb->num_pages == 2;
+    free(fb->shadow);
+    free(fb->dirty);
+    fb->shadow = NULL;
+    fb->dirty = fb->back_stale = fb->front_stale = NULL;
+    fb->num_pages = 1;
+    fb->back_page = 0;
+    update_draw_target(fb);
+
+    if (shadow && fb_enable_shadow(fb) != 0)
+    {
+        fprintf(stderr, "Failed to allocate shadow buffer for the new mode, drawing directly\n");
+    }
+    if (flip && fb_enable_page_flip(fb, fb->wait_vsync) != 0)
+    {
+        fprintf(stderr, "Page flipping unavailable in the new mode, using a single buffer\n");
+    }
+
+    return 1;
+}
+
+/* Flush dirty shadow rows to the page being drawn
+ * Each row copies the union of what changed and what that page missed while it
+ * was on screen, honouring line_length
+ */
+void fb_flush(Framebuffer *fb)
+{
+    if (!fb->shadow)
+    {
+        return;
+    }
+
+    uint8_t *target = page_origin(fb, fb->back_page);
+    bool flipping = fb->num_pages == 2;
+
+    for (uint32_t y = 0; y < fb->vinfo.yres; y++)
+    {
+        DirtySpan *span = &fb->dirty[y];
+        int x_start = span->x_start;
+        int x_end = span->x_end;
+
+        if (flipping)
+        {
+            // The other page now needs this row's changes too
+            mark_dirty(fb->front_stale, x_start, x_end, y);
+
+            DirtySpan *stale = &fb->back_stale[y];
+            if (stale->x_start < x_start)
+            {
+                x_start = stale->x_start;
+            }
+            if (stale->x_end > x_end)
+            {
+                x_end = stale->x_end;
+            }
+            stale->x_start = INT32_MAX;
+            stale->x_end = -1;
+        }
+
+        if (x_start <= x_end)
+        {
+            copy_row_span(fb, target, fb->shadow, x_start, x_end, y);
+        }
+
+        span->x_start = INT32_MAX;
+        span->x_end = -1;
+    }
+}
+
+/* Drop back to a single page after a failed pan
+ * The finished back page is copied onto the one being displayed
+ */
+static void fall_back_to_single_page(Framebuffer *fb)
+{
+    uint8_t *back = page_origin(fb, fb->back_page);
+    fb->num_pages = 1;
+    copy_stream(page_origin(fb, 0), back, fb->page_size);
+    update_draw_target(fb);
+}
+
+/* Make the rendered frame visible
+ * Flushes the shadow, then pans to the back page and brings the new back page
+ * up to date with the frame just shown
+ */
+void fb_present(Framebuffer *fb)
+{
+    fb_flush(fb);
+
+    if (fb->num_pages == 1)
+    {
+        return;
+    }
+
+    uint32_t yoffset = fb->back_page * fb->vinfo.yres;
+    if (fb->ops->pan(fb, yoffset) != 0)
+    {
+        fall_back_to_single_page(fb);
+        return;
+    }
+    fb->vinfo.yoffset = yoffset;
+
+    // Make sure the old front page is off screen before it is drawn into
+    if (fb->wait_vsync)
+    {
+        if (!fb->ops->wait_vsync || fb->ops->wait_vsync(fb) != 0)
+        {
+            fb->wait_vsync = false;
+        }
+    }
+
+    uint8_t *front = page_origin(fb, fb->back_page);
+    fb->back_page = 1 - fb->back_page;
+    uint8_t *back = page_origin(fb, fb->back_page);
+
+    for (uint32_t y = 0; y < fb->vinfo.yres; y++)
+    {
+        if (fb->shadow)
+        {
+            // Copied from the shadow on the next flush
+            fb->back_stale[y] = fb->front_stale[y];
+            fb->front_stale[y].x_start = INT32_MAX;
+            fb->front_stale[y].x_end = -1;
+        }
+        else if (fb->dirty[y].x_start <= fb->dirty[y].x_end)
+        {
+            // Without a shadow the only complete copy is the page just shown
+            copy_row_span(fb, back, front, fb->dirty[y].x_start, fb->dirty[y].x_end, y);
+            fb->dirty[y].x_start = INT32_MAX;
+            fb->dirty[y].x_end = -1;
+        }
+    }
+
+    update_draw_target(fb);
+}
+
+/* Write the page on screen, converted to 8-bit RGB, as a binary PPM */
+int fb_dump_ppm(const Framebuffer *fb, const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    if (!fp)
+    {
+        return -1;
+    }
+
+    uint32_t width = fb->vinfo.xres;
+    uint8_t *line = malloc((size_t)width * 3);
+    if (!line)
+    {
+        fclose(fp);
+        return -1;
+    }
+
+    const PixelFormat *fmt = &fb->format;
+    const uint8_t *page = fb->buffer + (size_t)fb->vinfo.yoffset * fb->finfo.line_length;
+    bool ok = fprintf(fp, "P6\n%u %u\n255\n", width, fb->vinfo.yres) > 0;
+
+    for (uint32_t y = 0; ok && y < fb->vinfo.yres; y++)
+    {
+        const uint8_t *src = page + (size_t)y * fb->finfo.line_length +
+                             (size_t)fb->vinfo.xoffset * fmt->bytes;
+        for (uint32_t x = 0; x < width; x++, src += fmt->bytes)
+        {
+            uint32_t color = fmt->read(fmt, src);
+            line[3 * x] = (color >> 16) & 0xff;
+            line[3 * x + 1] = (color >> 8) & 0xff;
+            line[3 * x + 2] = color & 0xff;
+        }
+        ok = fwrite(line, 3, width, fp) == width;
+    }
+
+    free(line);
+    ok = (fclose(fp) == 0) && ok;
+    return ok ? 0 : -1;
+}
+
 /* Clean up framebuffer resources
- * Unmaps memory and closes the device
+ * Releases the backend's buffer and descriptor, then the tracking state
  */
 void fb_cleanup(Framebuffer *fb)
 {
     if (fb)
     {
-        if (fb->buffer != MAP_FAILED && fb->buffer != NULL)
+        if (fb->ops && fb->ops->release)
         {
-            munmap(fb->buffer, fb->screensize);
-        }
-        if (fb->fd >= 0)
-        {
-            close(fb->fd);
+            fb->ops->release(fb);
         }
+        free(fb->shadow);
+        free(fb->dirty);
         free(fb);
     }
 }
 
-/* Set a pixel in the framebuffer
- * Handles bounds checking and pixel format
+/* Fill a horizontal span of pixels
+ * Clips once per span instead of once per pixel, then hands the whole run to
+ * the span writer for the pixel format
  */
-void set_pixel(Framebuffer *fb, uint32_t x, uint32_t y, uint32_t color)
+void fb_fill_span(Framebuffer *fb, int x_start, int x_end, int y, uint32_t color)
 {
-    // Check if pixel is within screen bounds
-    if (x >= fb->vinfo.xres || y >= fb->vinfo.yres)
+    // Clip to screen bounds
+    if (y < 0 || y >= (int)fb->vinfo.yres)
     {
         return;
     }
+    if (x_start < 0)
+    {
+        x_start = 0;
+    }
+    if (x_end >= (int)fb->vinfo.xres)
+    {
+        x_end = fb->vinfo.xres - 1;
+    }
+    if (x_start > x_end)
+    {
+        return;
+    }
+
+    // Calculate the row address once for the whole run
+    uint8_t *start = fb->draw + y * fb->finfo.line_length +
+                     (x_start + fb->vinfo.xoffset) * fb->format.bytes;
 
-    // Calculate pixel offset in framebuffer
-    size_t location = (x + fb->vinfo.xoffset) * (fb->vinfo.bits_per_pixel / 8) +
-                      (y + fb->vinfo.yoffset) * fb->finfo.line_length;
+    fb->format.fill(&fb->format, start, x_start, y, x_end - x_start + 1, color);
+
+    if (fb->dirty)
+    {
+        mark_dirty(fb->dirty, x_start, x_end, y);
+    }
+    if (fb->span_hook)
+    {
+        fb->span_hook(fb->span_hook_ctx, y, x_start, x_end, color);
+    }
+}
 
-    if (location >= fb->screensize)
+/* Blend a coverage run into the framebuffer
+ * Runs of zero coverage are skipped and runs of full coverage are filled, so
+ * only edge pixels pay for the read-modify-write
+ */
+void fb_blend_span(Framebuffer *fb, int x_start, int y, const uint8_t *alpha, int count,
+                   uint32_t color)
+{
+    // Clip to screen bounds
+    if (y < 0 || y >= (int)fb->vinfo.yres)
+    {
+        return;
+    }
+    if (x_start < 0)
+    {
+        alpha -= x_start;
+        count += x_start;
+        x_start = 0;
+    }
+    if (x_start + count > (int)fb->vinfo.xres)
+    {
+        count = fb->vinfo.xres - x_start;
+    }
+    if (count <= 0)
     {
         return;
     }
 
-    // Write pixel color (currently only supports 32-bit color depth)
-    if (fb->vinfo.bits_per_pixel == 32)
+    const PixelFormat *fmt = &fb->format;
+    uint8_t *row = fb->draw + y * fb->finfo.line_length +
+                   (x_start + fb->vinfo.xoffset) * fmt->bytes;
+    int i = 0;
+
+    while (i < count)
     {
-        *((uint32_t *)(fb->buffer + location)) = color;
+        // Skip uncovered pixels
+        if (alpha[i] == 0)
+        {
+            i++;
+            continue;
+        }
+
+        int run_start = i;
+        bool solid = alpha[i] == 255;
+        if (solid)
+        {
+            while (i < count && alpha[i] == 255)
+            {
+                i++;
+            }
+            fmt->fill(fmt, row + run_start * fmt->bytes, x_start + run_start, y,
+                      i - run_start, color);
+        }
+        else
+        {
+            while (i < count && alpha[i] != 0 && alpha[i] != 255)
+            {
+                i++;
+            }
+            fmt->blend(fmt, row + run_start * fmt->bytes, alpha + run_start, i - run_start, color);
+        }
+
+        if (fb->dirty)
+        {
+            mark_dirty(fb->dirty, x_start + run_start, x_start + i - 1, y);
+        }
+
+        // Report solid runs by source color and blended pixels as runs of
+        // identical final color
+        if (fb->span_hook && solid)
+        {
+            fb->span_hook(fb->span_hook_ctx, y, x_start + run_start, x_start + i - 1, color);
+        }
+        else if (fb->span_hook)
+        {
+            for (int j = run_start; j < i;)
+            {
+                uint32_t value = fmt->read(fmt, row + j * fmt->bytes);
+                int k = j + 1;
+                while (k < i && fmt->read(fmt, row + k * fmt->bytes) == value)
+                {
+                    k++;
+                }
+                fb->span_hook(fb->span_hook_ctx, y, x_start + j, x_start + k - 1, value);
+                j = k;
+            }
+        }
+    }
+}
+
+/* Fill a rectangle one clipped span per row */
+void fb_fill_rect(Framebuffer *fb, int x, int y, int width, int height, uint32_t color)
+{
+    int y_end = y + height;
+
+    if (y < 0)
+    {
+        y = 0;
+    }
+    if (y_end > (int)fb->vinfo.yres)
+    {
+        y_end = fb->vinfo.yres;
+    }
+
+    for (; y < y_end; y++)
+    {
+        fb_fill_span(fb, x, x + width - 1, y, color);
     }
 }
 
 /* Calculate display information for SVG rendering
  * Determines optimal SVG size and position while maintaining aspect ratio
  */
-DisplayInfo *calculate_display_info(Framebuffer *fb)
+DisplayInfo *calculate_display_info(Framebuffer *fb, int rotation, const ViewBox *view_box)
 {
     DisplayInfo *info = calloc(1, sizeof(DisplayInfo));
     if (!info)
@@ -118,23 +846,30 @@ DisplayInfo *calculate_display_info(Framebuffer *fb)
 
     info->screen_width = fb->vinfo.xres;
     info->screen_height = fb->vinfo.yres;
+    info->rotation = rotation;
+    info->view_box = *view_box;
+
+    // Fit the logo as it will appear on screen, after rotation
+    float rotated_width, rotated_height;
+    transform_rotated_extents(rotation, view_box->width, view_box->height,
+                              &rotated_width, &rotated_height);
 
     // Calculate SVG dimensions to fit in screen while maintaining aspect ratio
-    float target_width = info->screen_width * 0.6f;           // Use 80% of screen width
-    float target_height = target_width * (1284.0f / 1284.0f); // Maintain SVG aspect ratio
+    float target_width = info->screen_width * 0.6f;                    // Use 60% of screen width
+    float target_height = target_width * (rotated_height / rotated_width); // Maintain SVG aspect ratio
 
     // Adjust if height is too large
     if (target_height > info->screen_height * 0.6f)
     {
         target_height = info->screen_height * 0.6f;
-        target_width = target_height * (1284.0f / 1284.0f);
+        target_width = target_height * (rotated_width / rotated_height);
     }
 
-    // Set final dimensions and calculate centering offsets
-    info->svg_width = (uint32_t)target_width;
-    info->svg_height = (uint32_t)target_height;
-    info->x_offset = (info->screen_width - info->svg_width) / 2;
-    info->y_offset = (info->screen_height - info->svg_height) / 2;
+    // Set final unrotated dimensions and calculate centering offsets
+    info->svg_width = (uint32_t)(target_width * view_box->width / rotated_width);
+    info->svg_height = (uint32_t)(target_height * view_box->height / rotated_height);
+    info->x_offset = ((int32_t)info->screen_width - (int32_t)info->svg_width) / 2;
+    info->y_offset = ((int32_t)info->screen_height - (int32_t)info->svg_height) / 2;
 
     return info;
 }
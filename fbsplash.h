@@ -2,22 +2,86 @@
 #define FBSPLASH_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <linux/fb.h>
+#include "pixel_format.h"
+#include "svg_types.h"
+
+/* Dirty extent of one framebuffer row in pixels
+ * The row is clean when x_start > x_end
+ */
+typedef struct {
+    int32_t x_start;
+    int32_t x_end;
+} DirtySpan;
+
+typedef struct Framebuffer Framebuffer;
+
+/* Output backend operations
+ * The fbdev device is one backend; headless ones render into memory or a file.
+ * Optional operations are NULL when a backend cannot support them.
+ * name: Short backend name for messages
+ * pan: Show the page starting at row yoffset (NULL: no page flipping)
+ * wait_vsync: Block until the next vertical blank (NULL: never waits)
+ * grow_virtual: Enlarge yres_virtual to rows and remap (NULL: fixed size)
+ * query_mode: Read the mode currently set (NULL: the mode never changes)
+ * remap: Map again for the vinfo and finfo just stored, keeping the old
+ *        mapping on failure (required along with query_mode)
+ * release: Unmap the buffer and close any file descriptor
+ */
+typedef struct {
+    const char *name;
+    int (*pan)(Framebuffer *fb, uint32_t yoffset);
+    int (*wait_vsync)(Framebuffer *fb);
+    int (*grow_virtual)(Framebuffer *fb, uint32_t rows);
+    int (*query_mode)(Framebuffer *fb, struct fb_var_screeninfo *vinfo,
+                      struct fb_fix_screeninfo *finfo);
+    int (*remap)(Framebuffer *fb);
+    void (*release)(Framebuffer *fb);
+} FramebufferOps;
 
 /* Framebuffer structure holding device information and buffer
- * fd: File descriptor for the framebuffer device
- * buffer: Memory-mapped framebuffer
+ * ops: Backend operations
+ * fd: File descriptor for the framebuffer device or backing file, -1 if none
+ * buffer: Mapped (or allocated) framebuffer, covering the whole virtual area
  * vinfo: Variable screen information (resolution, bit depth, etc.)
  * finfo: Fixed screen information (memory length, line length, etc.)
- * screensize: Total size of the framebuffer in bytes
+ * format: Pixel layout and span writers resolved from vinfo
+ * screensize: Total size of the mapping in bytes
+ * page_size: Size of one visible page (line_length * yres) in bytes
+ * draw: Origin of the render target: the shadow, or the page being drawn
+ * shadow: Cached heap copy of one page, NULL in direct mode
+ * dirty: Per-row extents modified since the last flush or flip
+ * back_stale: Per-row extents the page being drawn has yet to receive
+ * front_stale: Per-row extents the displayed page has yet to receive
+ * num_pages: 1 for single buffering, 2 when page flipping
+ * back_page: Index of the page being drawn when page flipping
+ * wait_vsync: Wait for vertical sync after each flip
+ * dither: Ordered dithering was requested, kept across mode changes
+ * span_hook: Optional observer called with every span written, NULL if unused
+ * span_hook_ctx: Context pointer passed to span_hook
  */
-typedef struct {
+struct Framebuffer {
+    const FramebufferOps *ops;
     int fd;
     uint8_t *buffer;
     struct fb_var_screeninfo vinfo;
     struct fb_fix_screeninfo finfo;
+    PixelFormat format;
     size_t screensize;
-} Framebuffer;
+    size_t page_size;
+    uint8_t *draw;
+    uint8_t *shadow;
+    DirtySpan *dirty;
+    DirtySpan *back_stale;
+    DirtySpan *front_stale;
+    uint32_t num_pages;
+    uint32_t back_page;
+    bool wait_vsync;
+    bool dither;
+    void (*span_hook)(void *ctx, int y, int x_start, int x_end, uint32_t color);
+    void *span_hook_ctx;
+};
 
 /* Display information structure for SVG rendering
  * Contains screen and SVG dimensions and offsets for centering
@@ -27,29 +91,108 @@ typedef struct {
     uint32_t screen_height;  // Height of the screen in pixels
     uint32_t svg_width;      // Width of the scaled SVG
     uint32_t svg_height;     // Height of the scaled SVG
-    uint32_t x_offset;       // X offset for centering SVG
-    uint32_t y_offset;       // Y offset for centering SVG
+    int32_t x_offset;        // X offset for centering SVG (before rotation)
+    int32_t y_offset;        // Y offset for centering SVG (before rotation)
+    int rotation;            // Clockwise rotation about the screen center in degrees
+    ViewBox view_box;        // SVG user-space area fitted into svg_width x svg_height
 } DisplayInfo;
 
 /* Initialize the framebuffer device
+ * Supports 16, 24 and 32 bits per pixel with any RGB channel layout
  * Returns: Pointer to initialized Framebuffer structure or NULL on failure
  */
 Framebuffer* fb_init(const char *fb_device);
 
+/* Open a framebuffer from a device spec
+ * spec: fbdev device path, or a headless spec (see fb_headless.h)
+ * Returns: Pointer to initialized Framebuffer structure or NULL on failure
+ */
+Framebuffer* fb_open(const char *spec);
+
+/* Finish setting up a framebuffer whose backend filled in ops, fd, vinfo,
+ * finfo, buffer and screensize
+ * Resolves the pixel format and selects the single visible page.
+ * Returns: 0 on success, -1 if the format or layout is unusable
+ */
+int fb_setup(Framebuffer *fb);
+
+/* Write the visible page as a binary PPM image
+ * Returns: 0 on success, -1 on I/O error
+ */
+int fb_dump_ppm(const Framebuffer *fb, const char *path);
+
+/* Turn ordered dithering of solid fills on or off
+ * Only 16bpp modes dither; elsewhere this has no effect.
+ */
+void fb_set_dither(Framebuffer *fb, bool enable);
+
+/* Switch rendering to a cached shadow buffer
+ * All subsequent drawing goes to heap memory and reaches the device only
+ * through fb_flush. The shadow starts out black; nothing is read back from
+ * the device.
+ * Returns: 0 on success, -1 on allocation failure (direct mode is kept)
+ */
+int fb_enable_shadow(Framebuffer *fb);
+
+/* Render into an off-screen page and flip with FBIOPAN_DISPLAY
+ * Requires room for two pages in the virtual framebuffer; yres_virtual is
+ * grown when video memory allows it.
+ * wait_vsync: Wait for FBIO_WAITFORVSYNC after each flip
+ * Returns: 0 on success, -1 if unsupported (single buffering is kept)
+ */
+int fb_enable_page_flip(Framebuffer *fb, bool wait_vsync);
+
+/* Pick up a display mode set by someone else, e.g. after a hotplugged
+ * monitor or a console switch
+ * The mode is queried again and the buffer remapped only when its size or
+ * line length changed. Shadow buffering and page flipping are set up again
+ * for the new layout; their contents are lost, so the caller redraws.
+ * Returns: 1 if the layout changed, 0 if not, -1 if the mode cannot be
+ *          queried, drawn or mapped (the old layout is kept)
+ */
+int fb_reload_mode(Framebuffer *fb);
+
+/* Copy the dirty regions of the shadow buffer to the page being drawn
+ * Does nothing in direct mode. All rows are clean afterwards.
+ */
+void fb_flush(Framebuffer *fb);
+
+/* Show the finished frame
+ * Flushes the shadow buffer and, when page flipping, pans to the new page
+ */
+void fb_present(Framebuffer *fb);
+
 /* Clean up and free framebuffer resources */
 void fb_cleanup(Framebuffer *fb);
 
-/* Render an SVG to the framebuffer */
-void render_svg(Framebuffer *fb, const char *svg_data, DisplayInfo *display_info);
+/* Fill a horizontal run of pixels on row y from x_start to x_end inclusive
+ * The run is clipped to the screen; the row address is computed once and the
+ * pixels are written by the span writer for the pixel format.
+ * color: 32-bit RGBA color value
+ */
+void fb_fill_span(Framebuffer *fb, int x_start, int x_end, int y, uint32_t color);
+
+/* Blend color into a horizontal run of pixels on row y starting at x_start
+ * alpha: count coverage values, 0 keeps the pixel and 255 replaces it
+ * The run is clipped to the screen; fully covered runs are filled.
+ * color: 32-bit RGBA color value
+ */
+void fb_blend_span(Framebuffer *fb, int x_start, int y, const uint8_t *alpha, int count,
+                   uint32_t color);
 
-/* Set a single pixel in the framebuffer
+/* Fill a width x height rectangle with its top-left corner at (x, y)
+ * The rectangle is clipped to the screen
  * color: 32-bit RGBA color value
  */
-void set_pixel(Framebuffer *fb, uint32_t x, uint32_t y, uint32_t color);
+void fb_fill_rect(Framebuffer *fb, int x, int y, int width, int height, uint32_t color);
 
 /* Calculate display information for SVG rendering
+ * The logo is fitted by its extents after rotation, so a rotated logo on a
+ * portrait or landscape screen uses the same share of the screen.
+ * rotation: Clockwise rotation in degrees
+ * view_box: User-space area of the document to fit
  * Returns: Pointer to DisplayInfo structure with calculated values
  */
-DisplayInfo* calculate_display_info(Framebuffer *fb);
+DisplayInfo* calculate_display_info(Framebuffer *fb, int rotation, const ViewBox *view_box);
 
 #endif
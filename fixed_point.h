@@ -0,0 +1,132 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include <math.h>
+#include "svg_types.h"
+
+/* Arithmetic on PathCoord, the coordinate type of flattened paths
+ * Builds with SPLASH_FIXED_POINT (make FIXED_POINT=1) keep flattened points,
+ * the path-to-screen transform and edge stepping in 16.16 fixed point, for
+ * targets without a floating-point unit. Only per-path setup (composing the
+ * display transform, converting outline control points) and anti-aliased
+ * coverage, whose area sums stay in float, use floating point there.
+ *
+ * Tolerance against the float build: screen coordinates differ by at most
+ * about 1/64 pixel (16.16 rounding of the transform, scaled by path
+ * coordinates up to a few thousand units), and a cubic may get one segment
+ * more or fewer. Aliased output is identical except for pixels whose center
+ * lies within that distance of an edge, such as a whole row along a
+ * horizontal edge that falls exactly on a scanline; anti-aliased coverage
+ * differs by at most a few of 255 levels along edges. Path coordinates
+ * saturate at +-FIXED_PATH_LIMIT units (svg_document_parse scales documents
+ * down to fit), and transformed points are clamped to
+ * FIXED_COORD_LIMIT pixels around the origin (FLOAT_COORD_LIMIT in float
+ * builds), so rows and columns derived from them always fit in an int.
+ */
+
+#define FIXED_SHIFT 16
+#define FIXED_ONE (1 << FIXED_SHIFT)
+
+/* Largest path coordinate magnitude in units that 16.16 can hold */
+#define FIXED_PATH_LIMIT 32767
+
+/* Largest screen coordinate magnitude in pixels a fixed-point transform
+ * produces, so the difference of two coordinates still fits in 16.16
+ */
+#define FIXED_COORD_LIMIT 16383
+
+/* Largest screen coordinate magnitude in pixels a float transform produces,
+ * far off any screen but small enough that edge rows and columns fit in int
+ */
+#define FLOAT_COORD_LIMIT 16777216.0f
+
+/* Coordinate nearest to a float, saturated in fixed point; NaN gives 0 */
+static inline PathCoord coord_from_float(float v)
+{
+#ifdef SPLASH_FIXED_POINT
+    if (v != v)
+        return 0;
+    v = fminf(fmaxf(v, -(float)FIXED_PATH_LIMIT), (float)FIXED_PATH_LIMIT);
+    return (PathCoord)(v * FIXED_ONE + (v < 0.0f ? -0.5f : 0.5f));
+#else
+    return v;
+#endif
+}
+
+/* Coordinate of an integer */
+static inline PathCoord coord_from_int(int v)
+{
+#ifdef SPLASH_FIXED_POINT
+    return (PathCoord)((uint32_t)v << FIXED_SHIFT);
+#else
+    return (float)v;
+#endif
+}
+
+/* A coordinate as a float */
+static inline float coord_to_float(PathCoord v)
+{
+#ifdef SPLASH_FIXED_POINT
+    return (float)v / FIXED_ONE;
+#else
+    return v;
+#endif
+}
+
+/* Integer part, rounded toward zero like a float to int cast */
+static inline int coord_trunc(PathCoord v)
+{
+#ifdef SPLASH_FIXED_POINT
+    return v >= 0 ? v >> FIXED_SHIFT : -(-v >> FIXED_SHIFT);
+#else
+    return (int)v;
+#endif
+}
+
+/* Smallest integer not below a coordinate */
+static inline int coord_ceil(PathCoord v)
+{
+#ifdef SPLASH_FIXED_POINT
+    return (int)(((int64_t)v + FIXED_ONE - 1) >> FIXED_SHIFT);
+#else
+    return (int)ceilf(v);
+#endif
+}
+
+/* Product of two coordinates */
+static inline PathCoord coord_mul(PathCoord a, PathCoord b)
+{
+#ifdef SPLASH_FIXED_POINT
+    return (PathCoord)(((int64_t)a * b) >> FIXED_SHIFT);
+#else
+    return a * b;
+#endif
+}
+
+/* Quotient of two coordinates, saturated in fixed point; b must not be 0 */
+static inline PathCoord coord_div(PathCoord a, PathCoord b)
+{
+#ifdef SPLASH_FIXED_POINT
+    int64_t q = (int64_t)a * FIXED_ONE / b;
+    if (q > INT32_MAX)
+        return INT32_MAX;
+    if (q < INT32_MIN)
+        return INT32_MIN;
+    return (PathCoord)q;
+#else
+    return a / b;
+#endif
+}
+
+/* Offset n steps of size step from base, for stepping an edge down n rows */
+static inline PathCoord coord_step(PathCoord base, int n, PathCoord step)
+{
+#ifdef SPLASH_FIXED_POINT
+    return base + (PathCoord)((int64_t)n * step);
+#else
+    return base + n * step;
+#endif
+}
+
+#endif
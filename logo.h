@@ -0,0 +1,24 @@
+#ifndef LOGO_H
+#define LOGO_H
+
+#include <stddef.h>
+#include "svg_types.h"
+
+/* SVG path data and fill styles of the logo, one entry per component */
+extern const char *const svg_paths[];
+extern const char *const svg_colors[];
+extern const size_t logo_num_paths;
+
+/* viewBox of the document the logo paths come from */
+extern const ViewBox svg_view_box;
+
+/* Logo geometry baked at build time by svg_bake (see logo_geometry.c)
+ * Outlines are already parsed; curves are flattened at runtime with
+ * flatten_svg_outline once the on-screen scale is known.
+ * The arrays live in read-only storage and must not be modified.
+ */
+extern const SVGOutline logo_geometry[];
+extern const size_t logo_geometry_count;
+extern const ViewBox logo_view_box;
+
+#endif
@@ -0,0 +1,248 @@
+#include <string.h>
+#include "pixel_format.h"
+#include "span_fill.h"
+
+/* 4x4 Bayer matrix, scaled to quantization thresholds in [0, 255) */
+static const uint8_t bayer_threshold[4][4] = {
+    {   8, 136,  40, 168 },
+    { 200,  72, 232, 104 },
+    {  56, 184,  24, 152 },
+    { 248, 120, 216,  88 }
+};
+
+/* Threshold that rounds to the nearest level */
+#define ROUND_THRESHOLD 127
+
+/* Quantize one 8-bit channel to length bits and place it at shift
+ * threshold: 0 to 254, added before truncation; ROUND_THRESHOLD rounds
+ */
+static inline uint32_t pack_channel(uint32_t value, uint32_t length, uint32_t shift,
+                                    uint32_t threshold)
+{
+    uint32_t max = (1u << length) - 1;
+    return ((value * max + threshold) / 255) << shift;
+}
+
+/* Expand one channel of a pixel back to 8 bits by bit replication */
+static inline uint32_t unpack_channel(uint32_t pixel, uint32_t length, uint32_t shift)
+{
+    uint32_t value = (pixel >> shift) & ((1u << length) - 1);
+    return (value << (8 - length)) | (value >> (2 * length - 8));
+}
+
+/* Convert a 32-bit color value to the pixel layout */
+static inline uint32_t pack_color(const PixelFormat *fmt, uint32_t color, uint32_t threshold)
+{
+    return pack_channel((color >> 16) & 0xff, fmt->red_length, fmt->red_shift, threshold) |
+           pack_channel((color >> 8) & 0xff, fmt->green_length, fmt->green_shift, threshold) |
+           pack_channel(color & 0xff, fmt->blue_length, fmt->blue_shift, threshold);
+}
+
+/* Convert a pixel to a 32-bit color value */
+static inline uint32_t unpack_color(const PixelFormat *fmt, uint32_t pixel)
+{
+    return (unpack_channel(pixel, fmt->red_length, fmt->red_shift) << 16) |
+           (unpack_channel(pixel, fmt->green_length, fmt->green_shift) << 8) |
+           unpack_channel(pixel, fmt->blue_length, fmt->blue_shift);
+}
+
+/* Pixel loads and stores for each storage size, in host byte order */
+#define LOAD_16(p)     (*(const uint16_t *)(p))
+#define STORE_16(p, v) (*(uint16_t *)(p) = (uint16_t)(v))
+#define LOAD_24(p)     ((uint32_t)(p)[0] | (uint32_t)(p)[1] << 8 | (uint32_t)(p)[2] << 16)
+#define STORE_24(p, v) ((p)[0] = (uint8_t)(v), (p)[1] = (uint8_t)((v) >> 8), (p)[2] = (uint8_t)((v) >> 16))
+#define LOAD_32(p)     (*(const uint32_t *)(p))
+#define STORE_32(p, v) (*(uint32_t *)(p) = (v))
+
+/* Generate the reader and blender for one storage size
+ * Blended pixels are rounded rather than dithered and keep any bits
+ * outside the color channels (such as alpha).
+ */
+#define DEFINE_PIXEL_WRITERS(bits, BYTES)                                                    \
+    static uint32_t read_##bits(const PixelFormat *fmt, const uint8_t *src)                  \
+    {                                                                                        \
+        return unpack_color(fmt, LOAD_##bits(src));                                          \
+    }                                                                                        \
+                                                                                             \
+    static void blend_##bits(const PixelFormat *fmt, uint8_t *dst, const uint8_t *alpha,     \
+                             int count, uint32_t color)                                      \
+    {                                                                                        \
+        uint32_t src_r = (color >> 16) & 0xff;                                               \
+        uint32_t src_g = (color >> 8) & 0xff;                                                \
+        uint32_t src_b = color & 0xff;                                                       \
+                                                                                             \
+        for (int i = 0; i < count; i++, dst += BYTES)                                        \
+        {                                                                                    \
+            uint32_t pixel = LOAD_##bits(dst);                                               \
+            uint32_t old = unpack_color(fmt, pixel);                                         \
+            uint32_t mixed = (blend_channel(src_r, (old >> 16) & 0xff, alpha[i]) << 16) |    \
+                             (blend_channel(src_g, (old >> 8) & 0xff, alpha[i]) << 8) |      \
+                             blend_channel(src_b, old & 0xff, alpha[i]);                     \
+            pixel = (pixel & ~fmt->channel_mask) | pack_color(fmt, mixed, ROUND_THRESHOLD);  \
+            STORE_##bits(dst, pixel);                                                        \
+        }                                                                                    \
+    }
+
+DEFINE_PIXEL_WRITERS(16, 2)
+DEFINE_PIXEL_WRITERS(24, 3)
+DEFINE_PIXEL_WRITERS(32, 4)
+
+/* Fill 16-bit pixels with a pattern repeating every four pixels
+ * pattern: Pixel values for offsets 0 to 3 from dst
+ * Pairs of pixels are stored as aligned 32-bit words; a uniform pattern
+ * goes through the vectorized fill.
+ */
+static void fill_pattern_16(uint8_t *dst, const uint16_t pattern[4], int count)
+{
+    uint16_t *p = (uint16_t *)dst;
+    int i = 0;
+
+    if (((uintptr_t)p & 2) && count > 0)
+    {
+        p[0] = pattern[0];
+        i = 1;
+    }
+
+    uint32_t word0 = pattern[i & 3] | (uint32_t)pattern[(i + 1) & 3] << 16;
+    uint32_t word1 = pattern[(i + 2) & 3] | (uint32_t)pattern[(i + 3) & 3] << 16;
+    uint32_t *words = (uint32_t *)(p + i);
+    int num_words = (count - i) / 2;
+
+    if (word0 == word1)
+    {
+        fill_u32(words, word0, num_words);
+    }
+    else
+    {
+        for (int w = 0; w < num_words; w++)
+        {
+            words[w] = (w & 1) ? word1 : word0;
+        }
+    }
+
+    for (i += 2 * num_words; i < count; i++)
+    {
+        p[i] = pattern[i & 3];
+    }
+}
+
+/* Fill 16-bit pixels with the nearest color */
+static void fill_16(const PixelFormat *fmt, uint8_t *dst, int x, int y, int count, uint32_t color)
+{
+    (void)x;
+    (void)y;
+
+    uint16_t pixel = pack_color(fmt, color, ROUND_THRESHOLD);
+    uint16_t pattern[4] = { pixel, pixel, pixel, pixel };
+    fill_pattern_16(dst, pattern, count);
+}
+
+/* Fill 16-bit pixels with the color ordered-dithered against the screen position
+ * The threshold row only depends on y, so a run repeats every four pixels
+ */
+static void fill_16_dithered(const PixelFormat *fmt, uint8_t *dst, int x, int y, int count,
+                             uint32_t color)
+{
+    const uint8_t *thresholds = bayer_threshold[y & 3];
+    uint16_t pattern[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        pattern[i] = pack_color(fmt, color, thresholds[(x + i) & 3]);
+    }
+    fill_pattern_16(dst, pattern, count);
+}
+
+/* Fill 24-bit pixels three bytes at a time */
+static void fill_24(const PixelFormat *fmt, uint8_t *dst, int x, int y, int count, uint32_t color)
+{
+    (void)x;
+    (void)y;
+
+    uint32_t pixel = pack_color(fmt, color, ROUND_THRESHOLD);
+    for (int i = 0; i < count; i++, dst += 3)
+    {
+        STORE_24(dst, pixel);
+    }
+}
+
+/* Fill 32-bit pixels through the vectorized fill */
+static void fill_32(const PixelFormat *fmt, uint8_t *dst, int x, int y, int count, uint32_t color)
+{
+    (void)x;
+    (void)y;
+
+    fill_u32((uint32_t *)dst, pack_color(fmt, color, ROUND_THRESHOLD), count);
+}
+
+/* Check one channel bitfield fits inside a pixel */
+static bool valid_channel(const struct fb_bitfield *field, uint32_t bits)
+{
+    return field->length >= 4 && field->length <= 8 && field->offset + field->length <= bits;
+}
+
+/* Resolve the layout and pick the writers for its storage size */
+int pixel_format_init(PixelFormat *fmt, const struct fb_var_screeninfo *vinfo, bool dither)
+{
+    struct fb_bitfield red = vinfo->red;
+    struct fb_bitfield green = vinfo->green;
+    struct fb_bitfield blue = vinfo->blue;
+    uint32_t bits = vinfo->bits_per_pixel;
+
+    // Fall back to the common layout when the driver reports none
+    if (red.length == 0 && green.length == 0 && blue.length == 0)
+    {
+        if (bits == 16)
+        {
+            red = (struct fb_bitfield){ .offset = 11, .length = 5 };
+            green = (struct fb_bitfield){ .offset = 5, .length = 6 };
+            blue = (struct fb_bitfield){ .offset = 0, .length = 5 };
+        }
+        else
+        {
+            red = (struct fb_bitfield){ .offset = 16, .length = 8 };
+            green = (struct fb_bitfield){ .offset = 8, .length = 8 };
+            blue = (struct fb_bitfield){ .offset = 0, .length = 8 };
+        }
+    }
+
+    if ((bits != 16 && bits != 24 && bits != 32) ||
+        !valid_channel(&red, bits) || !valid_channel(&green, bits) || !valid_channel(&blue, bits))
+    {
+        return -1;
+    }
+
+    memset(fmt, 0, sizeof(*fmt));
+    fmt->bytes = bits / 8;
+    fmt->red_shift = red.offset;
+    fmt->green_shift = green.offset;
+    fmt->blue_shift = blue.offset;
+    fmt->red_length = red.length;
+    fmt->green_length = green.length;
+    fmt->blue_length = blue.length;
+    fmt->channel_mask = (((1u << red.length) - 1) << red.offset) |
+                        (((1u << green.length) - 1) << green.offset) |
+                        (((1u << blue.length) - 1) << blue.offset);
+
+    switch (bits)
+    {
+        case 16:
+            fmt->dither = dither;
+            fmt->fill = dither ? fill_16_dithered : fill_16;
+            fmt->blend = blend_16;
+            fmt->read = read_16;
+            break;
+        case 24:
+            fmt->fill = fill_24;
+            fmt->blend = blend_24;
+            fmt->read = read_24;
+            break;
+        default:
+            fmt->fill = fill_32;
+            fmt->blend = blend_32;
+            fmt->read = read_32;
+            break;
+    }
+
+    return 0;
+}
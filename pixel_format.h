@@ -0,0 +1,73 @@
+#ifndef PIXEL_FORMAT_H
+#define PIXEL_FORMAT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <linux/fb.h>
+
+typedef struct PixelFormat PixelFormat;
+
+/* Write count pixels of one color starting at dst, the pixel at screen (x, y)
+ * color: 32-bit RGBA color value
+ */
+typedef void (*PixelFillFunc)(const PixelFormat *fmt, uint8_t *dst, int x, int y, int count,
+                              uint32_t color);
+
+/* Blend color into count pixels starting at dst
+ * alpha: count coverage values, 0 keeps the pixel and 255 replaces it
+ */
+typedef void (*PixelBlendFunc)(const PixelFormat *fmt, uint8_t *dst, const uint8_t *alpha,
+                               int count, uint32_t color);
+
+/* Read the pixel at src back as a 32-bit color value */
+typedef uint32_t (*PixelReadFunc)(const PixelFormat *fmt, const uint8_t *src);
+
+/* Framebuffer pixel layout, resolved once from the mode
+ * The writers are specialized per storage size, so span loops never
+ * branch on the format.
+ * bytes: Bytes per pixel (2, 3 or 4)
+ * red_shift, green_shift, blue_shift: Bit offset of each channel in a pixel
+ * red_length, green_length, blue_length: Bits per channel (4 to 8)
+ * channel_mask: Bits covered by the three color channels
+ * dither: Fills use 4x4 ordered dithering (16bpp only)
+ * fill, blend, read: Span writers and reader for this layout
+ */
+struct PixelFormat {
+    uint32_t bytes;
+    uint8_t red_shift;
+    uint8_t green_shift;
+    uint8_t blue_shift;
+    uint8_t red_length;
+    uint8_t green_length;
+    uint8_t blue_length;
+    uint32_t channel_mask;
+    bool dither;
+    PixelFillFunc fill;
+    PixelBlendFunc blend;
+    PixelReadFunc read;
+};
+
+/* Blend one 8-bit channel: dst + (src - dst) * alpha / 255, rounded */
+static inline uint32_t blend_channel(uint32_t src, uint32_t dst, uint32_t alpha)
+{
+    uint32_t t = src * alpha + dst * (255 - alpha) + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+/* Blend two 32-bit color values channel by channel, as the blend writers do */
+static inline uint32_t blend_color(uint32_t src, uint32_t dst, uint32_t alpha)
+{
+    return (blend_channel((src >> 16) & 0xff, (dst >> 16) & 0xff, alpha) << 16) |
+           (blend_channel((src >> 8) & 0xff, (dst >> 8) & 0xff, alpha) << 8) |
+           blend_channel(src & 0xff, dst & 0xff, alpha);
+}
+
+/* Resolve the pixel layout of a mode and select its writers
+ * Drivers that leave the channel bitfields empty get the usual RGB565,
+ * RGB888 or XRGB8888 layout for their depth.
+ * dither: Request ordered dithering; ignored unless pixels are 16 bits
+ * Returns: 0 on success, -1 for depths or layouts without a writer
+ */
+int pixel_format_init(PixelFormat *fmt, const struct fb_var_screeninfo *vinfo, bool dither);
+
+#endif
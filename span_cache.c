@@ -0,0 +1,251 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "span_cache.h"
+
+#define SPAN_CACHE_MAGIC "MSPLSPAN"
+#define SPAN_CACHE_VERSION 3
+#define INITIAL_CAPACITY 1024
+
+/* On-disk header, followed directly by num_runs SpanRun records
+ * Stored in host byte order; the cache is only read back on the same machine
+ */
+typedef struct {
+    char magic[8];           // SPAN_CACHE_MAGIC, not terminated
+    uint32_t version;        // SPAN_CACHE_VERSION
+    uint32_t num_runs;       // Number of SpanRun records
+    SpanCacheKey key;        // Mode and geometry the runs were rendered for
+} SpanCacheHeader;
+
+struct SpanRecorder {
+    SpanRun *runs;           // Recorded runs in emission order
+    uint32_t num_runs;       // Number of runs recorded
+    uint32_t capacity;       // Allocated capacity of runs
+    bool overflow;           // A run was dropped for lack of memory
+};
+
+struct SpanCache {
+    void *map;               // Whole mapped file
+    size_t size;             // Mapped size in bytes
+    const SpanRun *runs;     // Runs following the header
+    uint32_t num_runs;       // Number of runs
+};
+
+/* 64-bit FNV-1a, continuing from hash */
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const uint8_t *bytes = data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/* Build the key for the current mode, rotation and geometry */
+void span_cache_make_key(SpanCacheKey *key, const Framebuffer *fb, int rotation,
+                         uint32_t render_mode, const SVGOutline *outlines, size_t num_outlines,
+                         const ViewBox *view_box)
+{
+    memset(key, 0, sizeof(*key));
+    key->xres = fb->vinfo.xres;
+    key->yres = fb->vinfo.yres;
+    key->bits_per_pixel = fb->vinfo.bits_per_pixel;
+    key->line_length = fb->finfo.line_length;
+    key->rotation = rotation;
+    key->render_mode = render_mode;
+    key->dither = fb->format.dither;
+
+    uint64_t hash = fnv1a(0xcbf29ce484222325ULL, view_box, sizeof(*view_box));
+    for (size_t i = 0; i < num_outlines; i++)
+    {
+        const SVGOutline *outline = &outlines[i];
+        hash = fnv1a(hash, &outline->fill_color, sizeof(outline->fill_color));
+        hash = fnv1a(hash, &outline->num_verbs, sizeof(outline->num_verbs));
+        hash = fnv1a(hash, outline->verbs, outline->num_verbs);
+        hash = fnv1a(hash, &outline->num_points, sizeof(outline->num_points));
+        hash = fnv1a(hash, outline->points, outline->num_points * sizeof(Point));
+    }
+    key->geometry_hash = hash;
+}
+
+/* Map and validate a cache file */
+SpanCache *span_cache_open(const char *path, const SpanCacheKey *key)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(SpanCacheHeader))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // Reject foreign, stale or truncated files
+    const SpanCacheHeader *header = map;
+    size_t expected = sizeof(SpanCacheHeader) + (size_t)header->num_runs * sizeof(SpanRun);
+    if (memcmp(header->magic, SPAN_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != SPAN_CACHE_VERSION ||
+        memcmp(&header->key, key, sizeof(*key)) != 0 ||
+        expected != (size_t)st.st_size)
+    {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    SpanCache *cache = malloc(sizeof(SpanCache));
+    if (!cache)
+    {
+        munmap(map, st.st_size);
+        return NULL;
+    }
+
+    cache->map = map;
+    cache->size = st.st_size;
+    cache->runs = (const SpanRun *)(header + 1);
+    cache->num_runs = header->num_runs;
+
+    return cache;
+}
+
+/* Replay cached runs straight into the framebuffer */
+void span_cache_blit(Framebuffer *fb, const SpanCache *cache)
+{
+    for (uint32_t i = 0; i < cache->num_runs; i++)
+    {
+        const SpanRun *run = &cache->runs[i];
+        fb_fill_span(fb, run->x_start, run->x_end, run->row, run->color);
+    }
+}
+
+/* Unmap a cache file and free its handle */
+void span_cache_close(SpanCache *cache)
+{
+    if (cache)
+    {
+        munmap(cache->map, cache->size);
+        free(cache);
+    }
+}
+
+/* Span hook appending each written run to the recorder */
+static void record_span(void *ctx, int y, int x_start, int x_end, uint32_t color)
+{
+    SpanRecorder *rec = ctx;
+
+    if (rec->num_runs >= rec->capacity)
+    {
+        uint32_t capacity = rec->capacity ? rec->capacity * 2 : INITIAL_CAPACITY;
+        SpanRun *runs = realloc(rec->runs, capacity * sizeof(SpanRun));
+        if (!runs)
+        {
+            rec->overflow = true;
+            return;
+        }
+        rec->runs = runs;
+        rec->capacity = capacity;
+    }
+
+    SpanRun *run = &rec->runs[rec->num_runs++];
+    run->row = (uint16_t)y;
+    run->x_start = (uint16_t)x_start;
+    run->x_end = (uint16_t)x_end;
+    run->padding = 0;
+    run->color = color;
+}
+
+/* Create an empty recorder */
+SpanRecorder *span_recorder_create(void)
+{
+    return calloc(1, sizeof(SpanRecorder));
+}
+
+/* Route fb's span hook into the recorder */
+void span_recorder_attach(SpanRecorder *rec, Framebuffer *fb)
+{
+    fb->span_hook = record_span;
+    fb->span_hook_ctx = rec;
+}
+
+/* Remove the recorder from fb if it is attached */
+void span_recorder_detach(SpanRecorder *rec, Framebuffer *fb)
+{
+    if (fb->span_hook_ctx == rec)
+    {
+        fb->span_hook = NULL;
+        fb->span_hook_ctx = NULL;
+    }
+}
+
+/* Write header and runs to a temporary file, then rename over path */
+int span_recorder_save(const SpanRecorder *rec, const char *path, const SpanCacheKey *key)
+{
+    // An incomplete recording must never be replayed
+    if (rec->overflow)
+    {
+        return -1;
+    }
+
+    // Coordinates are stored as 16-bit values
+    if (key->xres > UINT16_MAX + 1U || key->yres > UINT16_MAX + 1U)
+    {
+        return -1;
+    }
+
+    char tmp_path[4096];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path))
+    {
+        return -1;
+    }
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (!fp)
+    {
+        return -1;
+    }
+
+    SpanCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SPAN_CACHE_MAGIC, sizeof(header.magic));
+    header.version = SPAN_CACHE_VERSION;
+    header.num_runs = rec->num_runs;
+    header.key = *key;
+
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              fwrite(rec->runs, sizeof(SpanRun), rec->num_runs, fp) == rec->num_runs;
+    ok = (fclose(fp) == 0) && ok;
+
+    if (!ok || rename(tmp_path, path) == -1)
+    {
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* Free a recorder and its runs */
+void span_recorder_free(SpanRecorder *rec)
+{
+    if (rec)
+    {
+        free(rec->runs);
+        free(rec);
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef SPAN_CACHE_H
+#define SPAN_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "fbsplash.h"
+#include "svg_types.h"
+
+/* Everything a cached rasterization depends on
+ * A cache file is only used when all fields match the current boot
+ */
+typedef struct {
+    uint32_t xres;           // Visible width in pixels
+    uint32_t yres;           // Visible height in pixels
+    uint32_t bits_per_pixel; // Pixel depth
+    uint32_t line_length;    // Bytes per framebuffer row
+    uint32_t rotation;       // Device tree rotation in degrees
+    uint32_t render_mode;    // RenderMode used to rasterize
+    uint32_t dither;         // Ordered dithering of 16bpp fills
+    uint64_t geometry_hash;  // Hash of the rendered paths, colors and viewBox
+} SpanCacheKey;
+
+/* One horizontal run of a single color, inclusive on both ends */
+typedef struct {
+    uint16_t row;            // Screen row
+    uint16_t x_start;        // First pixel of the run
+    uint16_t x_end;          // Last pixel of the run
+    uint16_t padding;        // Unused, zero
+    uint32_t color;          // 32-bit RGBA color value
+} SpanRun;
+
+/* Spans collected while rendering, for writing out as a cache */
+typedef struct SpanRecorder SpanRecorder;
+
+/* Memory-mapped, validated cache file */
+typedef struct SpanCache SpanCache;
+
+/* Fill in a cache key for the current mode, rotation and geometry */
+void span_cache_make_key(SpanCacheKey *key, const Framebuffer *fb, int rotation,
+                         uint32_t render_mode, const SVGOutline *outlines, size_t num_outlines,
+                         const ViewBox *view_box);
+
+/* Map a cache file read-only and validate it against key
+ * Returns: Cache handle, or NULL if missing, corrupt or made for another key
+ */
+SpanCache *span_cache_open(const char *path, const SpanCacheKey *key);
+
+/* Write every cached run to the framebuffer in recorded order
+ * A cache recorded from a composited scene covers every pixel of the frame.
+ */
+void span_cache_blit(Framebuffer *fb, const SpanCache *cache);
+
+/* Unmap a cache file */
+void span_cache_close(SpanCache *cache);
+
+/* Create an empty recorder
+ * Returns: Recorder or NULL on allocation failure
+ */
+SpanRecorder *span_recorder_create(void);
+
+/* Start recording every span written to fb */
+void span_recorder_attach(SpanRecorder *rec, Framebuffer *fb);
+
+/* Stop recording spans written to fb */
+void span_recorder_detach(SpanRecorder *rec, Framebuffer *fb);
+
+/* Write the recorded runs to path, replacing any previous cache atomically
+ * Returns: 0 on success, -1 on failure (including runs lost to allocation failure)
+ */
+int span_recorder_save(const SpanRecorder *rec, const char *path, const SpanCacheKey *key);
+
+/* Free a recorder */
+void span_recorder_free(SpanRecorder *rec);
+
+#endif
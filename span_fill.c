@@ -0,0 +1,210 @@
+#include <pthread.h>
+#include <string.h>
+#include "span_fill.h"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define SPAN_FILL_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+#define SPAN_FILL_NEON 1
+#include <arm_neon.h>
+#endif
+
+/* Scalar fill used for short runs and unaligned heads/tails */
+static inline void fill_u32_scalar(uint32_t *dst, uint32_t value, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i] = value;
+    }
+}
+
+#if SPAN_FILL_X86
+/* SSE2 fill: align to 16 bytes, then write 64 bytes per iteration */
+static void fill_u32_sse2(uint32_t *dst, uint32_t value, size_t count)
+{
+    while (count && ((uintptr_t)dst & 15))
+    {
+        *dst++ = value;
+        count--;
+    }
+
+    __m128i v = _mm_set1_epi32((int)value);
+    for (; count >= 16; count -= 16, dst += 16)
+    {
+        _mm_store_si128((__m128i *)dst, v);
+        _mm_store_si128((__m128i *)(dst + 4), v);
+        _mm_store_si128((__m128i *)(dst + 8), v);
+        _mm_store_si128((__m128i *)(dst + 12), v);
+    }
+    for (; count >= 4; count -= 4, dst += 4)
+    {
+        _mm_store_si128((__m128i *)dst, v);
+    }
+    fill_u32_scalar(dst, value, count);
+}
+
+/* AVX2 fill: align to 32 bytes, then write 128 bytes per iteration */
+__attribute__((target("avx2")))
+static void fill_u32_avx2(uint32_t *dst, uint32_t value, size_t count)
+{
+    while (count && ((uintptr_t)dst & 31))
+    {
+        *dst++ = value;
+        count--;
+    }
+
+    __m256i v = _mm256_set1_epi32((int)value);
+    for (; count >= 32; count -= 32, dst += 32)
+    {
+        _mm256_store_si256((__m256i *)dst, v);
+        _mm256_store_si256((__m256i *)(dst + 8), v);
+        _mm256_store_si256((__m256i *)(dst + 16), v);
+        _mm256_store_si256((__m256i *)(dst + 24), v);
+    }
+    for (; count >= 8; count -= 8, dst += 8)
+    {
+        _mm256_store_si256((__m256i *)dst, v);
+    }
+    fill_u32_scalar(dst, value, count);
+}
+#endif
+
+#if SPAN_FILL_NEON
+/* NEON fill: write 64 bytes per iteration, NEON stores tolerate 4-byte alignment */
+static void fill_u32_neon(uint32_t *dst, uint32_t value, size_t count)
+{
+    uint32x4_t v = vdupq_n_u32(value);
+    for (; count >= 16; count -= 16, dst += 16)
+    {
+        vst1q_u32(dst, v);
+        vst1q_u32(dst + 4, v);
+        vst1q_u32(dst + 8, v);
+        vst1q_u32(dst + 12, v);
+    }
+    for (; count >= 4; count -= 4, dst += 4)
+    {
+        vst1q_u32(dst, v);
+    }
+    fill_u32_scalar(dst, value, count);
+}
+#endif
+
+/* Implementation selected once, before the first fill of any thread */
+static void (*fill_impl)(uint32_t *, uint32_t, size_t);
+static pthread_once_t fill_impl_once = PTHREAD_ONCE_INIT;
+
+/* Pick the widest fill the CPU supports */
+static void select_fill_impl(void)
+{
+#if SPAN_FILL_X86
+    fill_impl = __builtin_cpu_supports("avx2") ? fill_u32_avx2 : fill_u32_sse2;
+#elif SPAN_FILL_NEON
+    fill_impl = fill_u32_neon;
+#else
+    fill_impl = fill_u32_scalar;
+#endif
+}
+
+/* Fill a run of 32-bit words using the best available implementation */
+void fill_u32(uint32_t *dst, uint32_t value, size_t count)
+{
+    // Short runs are cheaper without the dispatch and alignment prologue
+    if (count < 8)
+    {
+        fill_u32_scalar(dst, value, count);
+        return;
+    }
+
+    // Band workers may make their first fills concurrently
+    pthread_once(&fill_impl_once, select_fill_impl);
+    fill_impl(dst, value, count);
+}
+
+/* Length of the run of value at the start of src */
+size_t run_length_u32(const uint32_t *src, uint32_t value, size_t count)
+{
+    size_t i = 0;
+
+#if SPAN_FILL_X86
+    __m128i v = _mm_set1_epi32((int)value);
+    for (; i + 4 <= count; i += 4)
+    {
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(src + i)), v));
+        if (mask != 0xffff)
+        {
+            return i + __builtin_ctz(~mask) / 4;
+        }
+    }
+#elif SPAN_FILL_NEON
+    uint32x4_t v = vdupq_n_u32(value);
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32x4_t eq = vceqq_u32(vld1q_u32(src + i), v);
+        uint32x2_t both = vand_u32(vget_low_u32(eq), vget_high_u32(eq));
+        if ((vget_lane_u32(both, 0) & vget_lane_u32(both, 1)) != 0xffffffffu)
+        {
+            break;
+        }
+    }
+#endif
+
+    // Tail, and the exact position within a mismatching NEON vector
+    while (i < count && src[i] == value)
+    {
+        i++;
+    }
+    return i;
+}
+
+/* Copy a run of bytes towards uncached or write-combined memory */
+void copy_stream(uint8_t *dst, const uint8_t *src, size_t size)
+{
+#if SPAN_FILL_X86
+    // Align the destination so the streaming stores cover whole 16-byte chunks
+    size_t head = (16 - ((uintptr_t)dst & 15)) & 15;
+    if (head > size)
+    {
+        head = size;
+    }
+    memcpy(dst, src, head);
+    dst += head;
+    src += head;
+    size -= head;
+
+    for (; size >= 64; size -= 64, dst += 64, src += 64)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)src);
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + 32));
+        __m128i d = _mm_loadu_si128((const __m128i *)(src + 48));
+        _mm_stream_si128((__m128i *)dst, a);
+        _mm_stream_si128((__m128i *)(dst + 16), b);
+        _mm_stream_si128((__m128i *)(dst + 32), c);
+        _mm_stream_si128((__m128i *)(dst + 48), d);
+    }
+    for (; size >= 16; size -= 16, dst += 16, src += 16)
+    {
+        _mm_stream_si128((__m128i *)dst, _mm_loadu_si128((const __m128i *)src));
+    }
+    memcpy(dst, src, size);
+
+    // Make the streamed data visible before anyone reads the device memory
+    _mm_sfence();
+#elif SPAN_FILL_NEON
+    for (; size >= 64; size -= 64, dst += 64, src += 64)
+    {
+        uint8x16_t a = vld1q_u8(src);
+        uint8x16_t b = vld1q_u8(src + 16);
+        uint8x16_t c = vld1q_u8(src + 32);
+        uint8x16_t d = vld1q_u8(src + 48);
+        vst1q_u8(dst, a);
+        vst1q_u8(dst + 16, b);
+        vst1q_u8(dst + 32, c);
+        vst1q_u8(dst + 48, d);
+    }
+    memcpy(dst, src, size);
+#else
+    memcpy(dst, src, size);
+#endif
+}
@@ -0,0 +1,25 @@
+#ifndef SPAN_FILL_H
+#define SPAN_FILL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fill count consecutive 32-bit words starting at dst with value
+ * Uses the widest vector unit available (AVX2, SSE2 or NEON) and falls
+ * back to a scalar loop elsewhere. dst needs only 4-byte alignment.
+ */
+void fill_u32(uint32_t *dst, uint32_t value, size_t count);
+
+/* Count how many of the count words starting at src equal value before the first that does not
+ * Compares four words at a time with SSE2 or NEON where available.
+ */
+size_t run_length_u32(const uint32_t *src, uint32_t value, size_t count);
+
+/* Copy size bytes from src to dst for write-only destinations
+ * Uses non-temporal stores on x86 so device memory receives full
+ * write-combined lines without polluting the cache; plain wide stores
+ * elsewhere. The regions must not overlap.
+ */
+void copy_stream(uint8_t *dst, const uint8_t *src, size_t size);
+
+#endif
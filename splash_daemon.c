@@ -0,0 +1,426 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include "splash_daemon.h"
+
+/* Client retries while the daemon socket does not exist yet */
+#define SEND_RETRIES 100
+#define SEND_RETRY_NS 10000000L
+
+/* Name of the foreground virtual console; sysfs signals changes with POLLPRI */
+#define CONSOLE_ACTIVE_PATH "/sys/class/tty/tty0/active"
+
+/* The console the splash is drawn on
+ * fd: Active console attribute, -1 when there is none to watch
+ * home: Console in the foreground when the daemon started
+ * away: Another console is in the foreground
+ */
+typedef struct {
+    int fd;
+    char home[32];
+    bool away;
+} ConsoleWatch;
+
+/* Current CLOCK_MONOTONIC time in nanoseconds */
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Fill in a socket address for path
+ * Returns: 0 on success, -1 if the path does not fit
+ */
+static int socket_address(struct sockaddr_un *addr, const char *path)
+{
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr->sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strcpy(addr->sun_path, path);
+    return 0;
+}
+
+/* Bind a datagram socket, so each command arrives whole in one receive */
+int daemon_listen(const char *path)
+{
+    struct sockaddr_un addr;
+    if (socket_address(&addr, path) != 0)
+    {
+        return -1;
+    }
+
+    // A socket left by an earlier run would make bind fail; anything else
+    // at the path is not ours to remove
+    struct stat st;
+    if (lstat(path, &st) == 0)
+    {
+        if (!S_ISSOCK(st.st_mode))
+        {
+            errno = EEXIST;
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int sock = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock == -1)
+    {
+        return -1;
+    }
+
+    // Only the owner may send commands: bind creates the file owner-only
+    mode_t old_mask = umask(0077);
+    int bound = bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+    umask(old_mask);
+    if (bound != 0)
+    {
+        int saved = errno;
+        close(sock);
+        errno = saved;
+        return -1;
+    }
+    return sock;
+}
+
+/* Parse a percentage argument
+ * Returns: true if arg is a whole number with nothing after it
+ */
+static bool parse_percent(const char *arg, int *percent)
+{
+    char *end;
+    errno = 0;
+    long value = strtol(arg, &end, 10);
+    if (end == arg || *end != '\0' || errno != 0)
+    {
+        return false;
+    }
+    *percent = value < 0 ? 0 : (value > 100 ? 100 : (int)value);
+    return true;
+}
+
+/* Read the name of the foreground console
+ * Reading from the start also re-arms the change notification.
+ * Returns: true on success
+ */
+static bool read_active_console(int fd, char *name, size_t size)
+{
+    ssize_t n = pread(fd, name, size - 1, 0);
+    if (n <= 0)
+    {
+        return false;
+    }
+    name[n] = '\0';
+    name[strcspn(name, "\n")] = '\0';
+    return true;
+}
+
+/* Start watching console switches, taking the foreground console as ours */
+static void console_watch_open(ConsoleWatch *watch)
+{
+    watch->away = false;
+    watch->fd = open(CONSOLE_ACTIVE_PATH, O_RDONLY | O_CLOEXEC);
+    if (watch->fd >= 0 && !read_active_console(watch->fd, watch->home, sizeof(watch->home)))
+    {
+        close(watch->fd);
+        watch->fd = -1;
+    }
+}
+
+/* Follow console switches
+ * Returns: true if our console has just come back to the foreground
+ */
+static bool console_returned(ConsoleWatch *watch)
+{
+    char active[sizeof(watch->home)];
+    if (watch->fd < 0 || !read_active_console(watch->fd, active, sizeof(active)))
+    {
+        return false;
+    }
+
+    bool was_away = watch->away;
+    watch->away = strcmp(active, watch->home) != 0;
+    return was_away && !watch->away;
+}
+
+/* Redraw the whole frame: the scene, then the bar and the line over it */
+static void repaint(DaemonTargets *targets)
+{
+    if (targets->scene)
+    {
+        if (render_scene_draw(targets->fb, targets->scene) != 0)
+        {
+            fprintf(stderr, "Out of memory compositing the scene, some rows were not drawn\n");
+        }
+    }
+    progress_bar_draw(targets->fb, targets->bar);
+    if (targets->text)
+    {
+        status_text_draw(targets->fb, targets->text);
+    }
+}
+
+/* Draw the frame again when the mode changed, or when the console was
+ * switched back and its contents drawn over meanwhile
+ * The recovery is timed from the mode query to the presented frame.
+ * refused: Set while the new mode cannot be drawn, so it is reported once
+ */
+static void recover_display(DaemonTargets *targets, bool returned, bool *refused,
+                            DaemonStats *stats)
+{
+    uint64_t start = now_ns();
+    int changed = fb_reload_mode(targets->fb);
+    if (changed < 0 && !*refused)
+    {
+        fprintf(stderr, "Display mode cannot be drawn, keeping the old layout\n");
+    }
+    *refused = changed < 0;
+    if (changed <= 0 && !returned)
+    {
+        return;
+    }
+
+    // Only a new layout needs the geometry laid out again
+    if (changed > 0 && targets->rebuild)
+    {
+        targets->rebuild(targets->rebuild_ctx, targets);
+    }
+    else
+    {
+        repaint(targets);
+    }
+    fb_present(targets->fb);
+    uint64_t elapsed = now_ns() - start;
+
+    stats->recoveries++;
+    if (elapsed > stats->recovery_ns_max)
+    {
+        stats->recovery_ns_max = elapsed;
+    }
+
+    const struct fb_var_screeninfo *mode = &targets->fb->vinfo;
+    fprintf(stderr, "%s %ux%u-%u, redrawn in %.3f ms\n",
+            changed > 0 ? "Display mode changed to" : "Console shown again at",
+            mode->xres, mode->yres, mode->bits_per_pixel, elapsed / 1e6);
+}
+
+/* Carry out one command
+ * Returns: 1 to keep going, 0 on quit, -1 if the command was rejected
+ */
+static int run_command(DaemonTargets *targets, char *command)
+{
+    // Trailing newlines come from shell clients using echo
+    size_t length = strlen(command);
+    while (length > 0 && (command[length - 1] == '\n' || command[length - 1] == '\r'))
+    {
+        command[--length] = '\0';
+    }
+
+    char *arg = strchr(command, ' ');
+    if (arg)
+    {
+        *arg++ = '\0';
+    }
+
+    if (strcmp(command, "progress") == 0)
+    {
+        int percent;
+        if (!arg || !parse_percent(arg, &percent))
+        {
+            return -1;
+        }
+        progress_bar_set(targets->fb, targets->bar, percent);
+        return 1;
+    }
+    if (strcmp(command, "text") == 0)
+    {
+        if (!targets->text || status_text_set(targets->fb, targets->text, arg ? arg : "") != 0)
+        {
+            fprintf(stderr, "Status: %s\n", arg ? arg : "");
+        }
+        return 1;
+    }
+    if (strcmp(command, "repaint") == 0 && !arg)
+    {
+        repaint(targets);
+        return 1;
+    }
+    if (strcmp(command, "quit") == 0 && !arg)
+    {
+        return 0;
+    }
+    return -1;
+}
+
+/* Receive loop; every command is presented before the next is read, so
+ * latency is bounded by the command's own redraw
+ * The wait for a command is cut short for the periodic mode check and for
+ * console switches. While another console is shown the mode is left alone;
+ * switching back redraws the frame for whatever mode is set by then.
+ */
+int daemon_run(int sock, DaemonTargets *targets, volatile sig_atomic_t *stop, DaemonStats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->latency_ns_min = UINT64_MAX;
+
+    ConsoleWatch console;
+    console_watch_open(&console);
+    bool refused = false;
+    uint64_t check_interval = DAEMON_MODE_CHECK_MS * 1000000ULL;
+    uint64_t next_check = now_ns() + check_interval;
+
+    char command[DAEMON_COMMAND_MAX];
+    int result = 0;
+    while (!*stop)
+    {
+        // poll skips the console entry when there is nothing to watch
+        struct pollfd fds[2] = {
+            { .fd = sock, .events = POLLIN },
+            { .fd = console.fd, .events = POLLPRI },
+        };
+        uint64_t now = now_ns();
+        int timeout = now >= next_check ? 0 : (int)((next_check - now + 999999) / 1000000);
+        if (poll(fds, 2, timeout) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            result = -1;
+            break;
+        }
+
+        // Recover the display before a command draws into it
+        if (fds[1].revents || now_ns() >= next_check)
+        {
+            bool returned = console_returned(&console);
+            if (!console.away)
+            {
+                recover_display(targets, returned, &refused, stats);
+            }
+            next_check = now_ns() + check_interval;
+        }
+
+        if (!fds[0].revents)
+        {
+            continue;
+        }
+        ssize_t n = recv(sock, command, sizeof(command) - 1, MSG_DONTWAIT);
+        if (n < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+            {
+                continue;
+            }
+            result = -1;
+            break;
+        }
+
+        uint64_t start = now_ns();
+        command[n] = '\0';
+        int status = run_command(targets, command);
+        if (status < 0)
+        {
+            stats->rejected++;
+            continue;
+        }
+        if (status == 0)
+        {
+            break;
+        }
+
+        fb_present(targets->fb);
+        uint64_t elapsed = now_ns() - start;
+
+        stats->commands++;
+        stats->latency_ns_total += elapsed;
+        if (elapsed < stats->latency_ns_min)
+        {
+            stats->latency_ns_min = elapsed;
+        }
+        if (elapsed > stats->latency_ns_max)
+        {
+            stats->latency_ns_max = elapsed;
+        }
+    }
+
+    if (console.fd >= 0)
+    {
+        close(console.fd);
+    }
+    if (stats->commands == 0)
+    {
+        stats->latency_ns_min = 0;
+    }
+    return result;
+}
+
+/* Stop listening; later sends fail instead of queueing */
+void daemon_close(int sock, const char *path)
+{
+    if (sock >= 0)
+    {
+        close(sock);
+        unlink(path);
+    }
+}
+
+/* Send over an unbound datagram socket, waiting out a daemon that has
+ * not bound its socket yet
+ */
+int daemon_send(const char *path, const char *command)
+{
+    struct sockaddr_un addr;
+    if (socket_address(&addr, path) != 0)
+    {
+        return -1;
+    }
+
+    size_t length = strlen(command);
+    if (length >= DAEMON_COMMAND_MAX)
+    {
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock == -1)
+    {
+        return -1;
+    }
+
+    int result = -1;
+    for (int attempt = 0; attempt <= SEND_RETRIES; attempt++)
+    {
+        if (sendto(sock, command, length, 0, (struct sockaddr *)&addr, sizeof(addr)) ==
+            (ssize_t)length)
+        {
+            result = 0;
+            break;
+        }
+        if (errno != ENOENT && errno != ECONNREFUSED)
+        {
+            break;
+        }
+
+        struct timespec pause = { 0, SEND_RETRY_NS };
+        nanosleep(&pause, NULL);
+    }
+
+    int saved = errno;
+    close(sock);
+    errno = saved;
+    return result;
+}
@@ -0,0 +1,89 @@
+#ifndef SPLASH_DAEMON_H
+#define SPLASH_DAEMON_H
+
+#include <stdint.h>
+#include <signal.h>
+#include "fbsplash.h"
+#include "svg_renderer.h"
+#include "animation.h"
+#include "status_text.h"
+
+/* Longest command accepted, terminator included */
+#define DAEMON_COMMAND_MAX 256
+
+/* Longest a display mode change goes unnoticed */
+#define DAEMON_MODE_CHECK_MS 250
+
+/*
+ * Command channel of a resident splash
+ *
+ * The daemon keeps the framebuffer mapping and the logo scene and takes one
+ * command per datagram on a Unix socket:
+ *   progress N     Fill the progress bar to N percent (0-100)
+ *   text MESSAGE   Set the status line
+ *   repaint        Redraw the whole frame from the resident scene
+ *   quit           Stop the daemon
+ * Each command redraws only what it changes and is presented before the
+ * next one is read.
+ *
+ * Between commands the daemon watches the display. When the framebuffer
+ * mode changes (a hotplugged monitor, a driver reset) or the console it
+ * started on is switched back to, the frame is drawn again and the time
+ * to recover is reported.
+ */
+
+typedef struct DaemonTargets DaemonTargets;
+
+/* What the commands draw into
+ * rebuild: Lay out the scene, bar and line for the mode fb has just been
+ *          switched to and draw the whole frame, replacing scene and text;
+ *          NULL to repaint the old layout instead
+ */
+struct DaemonTargets {
+    Framebuffer *fb;
+    const RenderScene *scene;   // Redrawn by repaint, NULL to only redraw the bar
+    ProgressBar *bar;           // Determinate bar under the logo
+    StatusText *text;           // Status line, NULL to log messages to stderr
+    void (*rebuild)(void *ctx, DaemonTargets *targets);
+    void *rebuild_ctx;          // Context pointer passed to rebuild
+};
+
+/* Command timing collected by daemon_run */
+typedef struct {
+    uint64_t commands;          // Commands carried out
+    uint64_t rejected;          // Unknown or malformed commands
+    uint64_t latency_ns_min;    // Fastest command, from receipt to presented pixels
+    uint64_t latency_ns_max;    // Slowest command
+    uint64_t latency_ns_total;  // Sum over all commands
+    uint64_t recoveries;        // Frames redrawn for a new mode or a returning console
+    uint64_t recovery_ns_max;   // Slowest recovery, from noticing to presented pixels
+} DaemonStats;
+
+/* Bind the command socket at path, replacing a stale socket file
+ * Anything at path other than a socket is left alone and fails with EEXIST.
+ * The socket is accessible to its owner only, so only the user running the
+ * splash (or root) can send commands. Commands sent before daemon_run starts
+ * are queued by the socket.
+ * Returns: Socket descriptor, or -1 on failure
+ */
+int daemon_listen(const char *path);
+
+/* Carry out commands until quit or until *stop becomes non-zero
+ * Mode changes are looked for every DAEMON_MODE_CHECK_MS, and at once
+ * when the active console changes.
+ * stop: Set asynchronously (e.g. from a signal handler) to end the loop;
+ *       the handler must not restart the blocking receive
+ * Returns: 0 when done, -1 if the socket failed
+ */
+int daemon_run(int sock, DaemonTargets *targets, volatile sig_atomic_t *stop, DaemonStats *stats);
+
+/* Close the command socket and remove its file */
+void daemon_close(int sock, const char *path);
+
+/* Send one command to the daemon listening at path
+ * Retries for up to a second while the daemon is still starting.
+ * Returns: 0 on success, -1 on failure (errno is set)
+ */
+int daemon_send(const char *path, const char *command);
+
+#endif
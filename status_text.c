@@ -0,0 +1,436 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "status_text.h"
+#include "transform.h"
+
+/* Printable ASCII, the characters the font covers */
+#define FONT_FIRST ' '
+#define FONT_LAST '~'
+
+/* Glyph cell in font pixels: 7 rows above the baseline and 2 below for
+ * descenders; characters advance by one column more than a glyph is wide
+ */
+#define FONT_WIDTH 5
+#define FONT_ROWS 9
+#define FONT_ADVANCE 6
+
+/* Glyph cap height as a fraction of the logo height */
+#define TEXT_CAP_DIVISOR 20
+
+/* Messages whose composed lines are kept */
+#define LINE_CACHE_SIZE 8
+
+/* Rows of each glyph, bit 4 the leftmost column */
+static const uint8_t font_glyphs[FONT_LAST - FONT_FIRST + 1][FONT_ROWS] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ' '
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04, 0x00, 0x00 },  // '!'
+    { 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '"'
+    { 0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a, 0x00, 0x00 },  // '#'
+    { 0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04, 0x00, 0x00 },  // '$'
+    { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03, 0x00, 0x00 },  // '%'
+    { 0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d, 0x00, 0x00 },  // '&'
+    { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '\''
+    { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02, 0x00, 0x00 },  // '('
+    { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08, 0x00, 0x00 },  // ')'
+    { 0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00, 0x00, 0x00 },  // '*'
+    { 0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00, 0x00, 0x00 },  // '+'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08, 0x00 },  // ','
+    { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '-'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c, 0x00, 0x00 },  // '.'
+    { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00, 0x00, 0x00 },  // '/'
+    { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e, 0x00, 0x00 },  // '0'
+    { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 },  // '1'
+    { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f, 0x00, 0x00 },  // '2'
+    { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e, 0x00, 0x00 },  // '3'
+    { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02, 0x00, 0x00 },  // '4'
+    { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e, 0x00, 0x00 },  // '5'
+    { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e, 0x00, 0x00 },  // '6'
+    { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08, 0x00, 0x00 },  // '7'
+    { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e, 0x00, 0x00 },  // '8'
+    { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c, 0x00, 0x00 },  // '9'
+    { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00, 0x00, 0x00 },  // ':'
+    { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08, 0x00, 0x00 },  // ';'
+    { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00 },  // '<'
+    { 0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00, 0x00, 0x00 },  // '='
+    { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08, 0x00, 0x00 },  // '>'
+    { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04, 0x00, 0x00 },  // '?'
+    { 0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e, 0x00, 0x00 },  // '@'
+    { 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00, 0x00 },  // 'A'
+    { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e, 0x00, 0x00 },  // 'B'
+    { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e, 0x00, 0x00 },  // 'C'
+    { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c, 0x00, 0x00 },  // 'D'
+    { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f, 0x00, 0x00 },  // 'E'
+    { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10, 0x00, 0x00 },  // 'F'
+    { 0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f, 0x00, 0x00 },  // 'G'
+    { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11, 0x00, 0x00 },  // 'H'
+    { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 },  // 'I'
+    { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c, 0x00, 0x00 },  // 'J'
+    { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11, 0x00, 0x00 },  // 'K'
+    { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f, 0x00, 0x00 },  // 'L'
+    { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11, 0x00, 0x00 },  // 'M'
+    { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11, 0x00, 0x00 },  // 'N'
+    { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 },  // 'O'
+    { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10, 0x00, 0x00 },  // 'P'
+    { 0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d, 0x00, 0x00 },  // 'Q'
+    { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11, 0x00, 0x00 },  // 'R'
+    { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e, 0x00, 0x00 },  // 'S'
+    { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00 },  // 'T'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 },  // 'U'
+    { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00, 0x00 },  // 'V'
+    { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a, 0x00, 0x00 },  // 'W'
+    { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11, 0x00, 0x00 },  // 'X'
+    { 0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04, 0x00, 0x00 },  // 'Y'
+    { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f, 0x00, 0x00 },  // 'Z'
+    { 0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e, 0x00, 0x00 },  // '['
+    { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00, 0x00 },  // '\\'
+    { 0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e, 0x00, 0x00 },  // ']'
+    { 0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '^'
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x00 },  // '_'
+    { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '`'
+    { 0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f, 0x00, 0x00 },  // 'a'
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e, 0x00, 0x00 },  // 'b'
+    { 0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e, 0x00, 0x00 },  // 'c'
+    { 0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f, 0x00, 0x00 },  // 'd'
+    { 0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e, 0x00, 0x00 },  // 'e'
+    { 0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08, 0x00, 0x00 },  // 'f'
+    { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x11, 0x0f, 0x01, 0x0e },  // 'g'
+    { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00 },  // 'h'
+    { 0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 },  // 'i'
+    { 0x02, 0x00, 0x06, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c },  // 'j'
+    { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12, 0x00, 0x00 },  // 'k'
+    { 0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e, 0x00, 0x00 },  // 'l'
+    { 0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11, 0x00, 0x00 },  // 'm'
+    { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11, 0x00, 0x00 },  // 'n'
+    { 0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e, 0x00, 0x00 },  // 'o'
+    { 0x00, 0x00, 0x1e, 0x11, 0x11, 0x11, 0x1e, 0x10, 0x10 },  // 'p'
+    { 0x00, 0x00, 0x0f, 0x11, 0x11, 0x11, 0x0f, 0x01, 0x01 },  // 'q'
+    { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10, 0x00, 0x00 },  // 'r'
+    { 0x00, 0x00, 0x0f, 0x10, 0x0e, 0x01, 0x1e, 0x00, 0x00 },  // 's'
+    { 0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06, 0x00, 0x00 },  // 't'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d, 0x00, 0x00 },  // 'u'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04, 0x00, 0x00 },  // 'v'
+    { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a, 0x00, 0x00 },  // 'w'
+    { 0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x00, 0x00 },  // 'x'
+    { 0x00, 0x00, 0x11, 0x11, 0x11, 0x11, 0x0f, 0x01, 0x0e },  // 'y'
+    { 0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f, 0x00, 0x00 },  // 'z'
+    { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02, 0x00, 0x00 },  // '{'
+    { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x00 },  // '|'
+    { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08, 0x00, 0x00 },  // '}'
+    { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00, 0x00, 0x00 },  // '~'
+};
+
+/* A message composed for the screen */
+typedef struct
+{
+    char *message;       // NULL while the slot is free
+    uint8_t *alpha;      // Coverage, width x height in screen orientation
+    int x, y;            // Screen position of the top-left corner
+    int width, height;   // Screen size
+    uint64_t last_used;  // Clock of the last use, for eviction
+} StatusLine;
+
+struct StatusText
+{
+    uint8_t *atlas;      // Coverage of every glyph, glyph_width x glyph_height each
+    int glyph_width;     // Glyph cell on screen
+    int glyph_height;
+    int advance;         // Screen pixels from one character to the next
+    int center_x;        // Point the layout is rotated about; lines center on its x
+    int center_y;
+    int top;             // Layout row of the top of the line
+    int rotation;
+    uint32_t color;
+    uint32_t background;
+    StatusLine lines[LINE_CACHE_SIZE];
+    StatusLine *current; // Line on screen, NULL when none is
+    uint64_t clock;
+};
+
+/* Length of the overlap of [a0, a1) and [b0, b1) */
+static float overlap(float a0, float a1, float b0, float b1)
+{
+    float lo = a0 > b0 ? a0 : b0;
+    float hi = a1 < b1 ? a1 : b1;
+    return hi > lo ? hi - lo : 0.0f;
+}
+
+/* Scale one glyph into coverage by the area each font pixel covers of
+ * each screen pixel
+ * acc: Scratch of width x height floats
+ */
+static void render_glyph(uint8_t *out, float *acc, const uint8_t *rows, float scale,
+                         int width, int height)
+{
+    memset(acc, 0, (size_t)width * height * sizeof(float));
+
+    for (int fy = 0; fy < FONT_ROWS; fy++)
+    {
+        for (int fx = 0; fx < FONT_WIDTH; fx++)
+        {
+            if (!(rows[fy] & (0x10 >> fx)))
+            {
+                continue;
+            }
+
+            float x0 = fx * scale, x1 = x0 + scale;
+            float y0 = fy * scale, y1 = y0 + scale;
+            for (int py = (int)y0; py < height && py < y1; py++)
+            {
+                float cover_y = overlap(py, py + 1, y0, y1);
+                for (int px = (int)x0; px < width && px < x1; px++)
+                {
+                    acc[py * width + px] += cover_y * overlap(px, px + 1, x0, x1);
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < width * height; i++)
+    {
+        float a = acc[i] > 1.0f ? 1.0f : acc[i];
+        out[i] = (uint8_t)(a * 255.0f + 0.5f);
+    }
+}
+
+/* Build the glyph atlas for a scale
+ * Returns: 0 on success, -1 on allocation failure
+ */
+static int build_atlas(StatusText *text, float scale)
+{
+    text->glyph_width = (int)ceilf(FONT_WIDTH * scale);
+    text->glyph_height = (int)ceilf(FONT_ROWS * scale);
+    text->advance = (int)(FONT_ADVANCE * scale + 0.5f);
+
+    size_t glyph_size = (size_t)text->glyph_width * text->glyph_height;
+    int num_glyphs = FONT_LAST - FONT_FIRST + 1;
+    text->atlas = malloc(glyph_size * num_glyphs);
+    float *acc = malloc(glyph_size * sizeof(float));
+    if (!text->atlas || !acc)
+    {
+        free(acc);
+        return -1;
+    }
+
+    for (int g = 0; g < num_glyphs; g++)
+    {
+        render_glyph(text->atlas + g * glyph_size, acc, font_glyphs[g], scale,
+                     text->glyph_width, text->glyph_height);
+    }
+
+    free(acc);
+    return 0;
+}
+
+/* Lay out a status line centered under the logo */
+StatusText *status_text_create(const DisplayInfo *display_info, int rotation, int top,
+                               uint32_t color, uint32_t background)
+{
+    StatusText *text = calloc(1, sizeof(StatusText));
+    if (!text)
+    {
+        return NULL;
+    }
+
+    // Cap height, 7 font rows, a fixed share of the logo; never below 1:1
+    float scale = (float)display_info->svg_height / (TEXT_CAP_DIVISOR * 7);
+    if (scale < 1.0f)
+    {
+        scale = 1.0f;
+    }
+    if (build_atlas(text, scale) != 0)
+    {
+        status_text_free(text);
+        return NULL;
+    }
+
+    text->center_x = display_info->x_offset + display_info->svg_width / 2;
+    text->center_y = display_info->y_offset + display_info->svg_height / 2;
+    text->top = top;
+    text->rotation = rotation;
+    text->color = color;
+    text->background = background;
+    return text;
+}
+
+/* Forget a cached line */
+static void line_clear(StatusLine *line)
+{
+    free(line->message);
+    free(line->alpha);
+    memset(line, 0, sizeof(*line));
+}
+
+/* Copy the glyphs of a message out of the atlas into an upright line, then
+ * turn it to the screen orientation
+ * Returns: 0 on success, -1 on allocation failure
+ */
+static int compose_line(const StatusText *text, StatusLine *line, const char *message)
+{
+    int count = (int)strlen(message);
+    int width = (count - 1) * text->advance + text->glyph_width;
+    int height = text->glyph_height;
+    size_t glyph_size = (size_t)text->glyph_width * text->glyph_height;
+
+    uint8_t *upright = calloc((size_t)width * height, 1);
+    line->alpha = malloc((size_t)width * height);
+    line->message = strdup(message);
+    if (!upright || !line->alpha || !line->message)
+    {
+        free(upright);
+        line_clear(line);
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        unsigned char c = (unsigned char)message[i];
+        if (c < FONT_FIRST || c > FONT_LAST)
+        {
+            c = '?';
+        }
+
+        const uint8_t *glyph = text->atlas + (c - FONT_FIRST) * glyph_size;
+        for (int row = 0; row < height; row++)
+        {
+            memcpy(upright + (size_t)row * width + i * text->advance,
+                   glyph + row * text->glyph_width, text->glyph_width);
+        }
+    }
+
+    line->x = text->center_x - width / 2;
+    line->y = text->top;
+    line->width = width;
+    line->height = height;
+    transform_rotate_rect(text->rotation, text->center_x, text->center_y,
+                          &line->x, &line->y, &line->width, &line->height);
+
+    // Same pixel mapping as transform_rotate_rect, relative to the corners
+    for (int ly = 0; ly < height; ly++)
+    {
+        for (int lx = 0; lx < width; lx++)
+        {
+            int sx = lx, sy = ly;
+            switch (text->rotation)
+            {
+                case 90:
+                    sx = height - 1 - ly;
+                    sy = lx;
+                    break;
+                case 180:
+                    sx = width - 1 - lx;
+                    sy = height - 1 - ly;
+                    break;
+                case 270:
+                    sx = ly;
+                    sy = width - 1 - lx;
+                    break;
+                default:
+                    break;
+            }
+            line->alpha[(size_t)sy * line->width + sx] = upright[(size_t)ly * width + lx];
+        }
+    }
+
+    free(upright);
+    return 0;
+}
+
+/* Cached line of a message, composing it into the least recently used
+ * slot other than the one on screen on a miss
+ * Returns: Line, or NULL on allocation failure
+ */
+static StatusLine *line_lookup(StatusText *text, const char *message)
+{
+    StatusLine *victim = NULL;
+    for (int i = 0; i < LINE_CACHE_SIZE; i++)
+    {
+        StatusLine *line = &text->lines[i];
+        if (line->message && strcmp(line->message, message) == 0)
+        {
+            line->last_used = ++text->clock;
+            return line;
+        }
+        if (line != text->current && (!victim || line->last_used < victim->last_used))
+        {
+            victim = line;
+        }
+    }
+
+    line_clear(victim);
+    if (compose_line(text, victim, message) != 0)
+    {
+        return NULL;
+    }
+    victim->last_used = ++text->clock;
+    return victim;
+}
+
+/* Blend a line over the screen, one span per row */
+static void line_blit(Framebuffer *fb, const StatusText *text, const StatusLine *line)
+{
+    for (int row = 0; row < line->height; row++)
+    {
+        fb_blend_span(fb, line->x, line->y + row, line->alpha + (size_t)row * line->width,
+                      line->width, text->color);
+    }
+}
+
+/* Erase the old line's box, then blend the new line into its own box */
+int status_text_set(Framebuffer *fb, StatusText *text, const char *message)
+{
+    StatusLine *line = NULL;
+    if (*message)
+    {
+        line = line_lookup(text, message);
+        if (line && line == text->current)
+        {
+            return 0;
+        }
+    }
+
+    if (text->current)
+    {
+        const StatusLine *old = text->current;
+        fb_fill_rect(fb, old->x, old->y, old->width, old->height, text->background);
+    }
+
+    text->current = line;
+    if (line)
+    {
+        line_blit(fb, text, line);
+    }
+    return *message && !line ? -1 : 0;
+}
+
+/* Erase and blend the current line in place */
+void status_text_draw(Framebuffer *fb, const StatusText *text)
+{
+    const StatusLine *line = text->current;
+    if (line)
+    {
+        fb_fill_rect(fb, line->x, line->y, line->width, line->height, text->background);
+        line_blit(fb, text, line);
+    }
+}
+
+/* The current line keeps its message */
+const char *status_text_message(const StatusText *text)
+{
+    return text->current ? text->current->message : "";
+}
+
+/* Free everything, cached lines included */
+void status_text_free(StatusText *text)
+{
+    if (!text)
+    {
+        return;
+    }
+    for (int i = 0; i < LINE_CACHE_SIZE; i++)
+    {
+        line_clear(&text->lines[i]);
+    }
+    free(text->atlas);
+    free(text);
+}
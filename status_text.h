@@ -0,0 +1,40 @@
+#ifndef STATUS_TEXT_H
+#define STATUS_TEXT_H
+
+#include <stdint.h>
+#include "fbsplash.h"
+
+/* Status line drawn under the logo with the built-in bitmap font
+ * The font's 5x7 glyphs are scaled to the logo size once, into an atlas
+ * of anti-aliased glyph coverage. A message is composed from the atlas
+ * into a line of coverage, rotated to the screen and kept in a small cache,
+ * so a message shown again is blended straight from its cached line. Only
+ * the boxes of the old and the new line are redrawn.
+ */
+typedef struct StatusText StatusText;
+
+/* Set up the line centered under the logo, its top top pixels down in the
+ * unrotated layout
+ * rotation: Device tree rotation, applied around the logo center
+ * color: Text color; background: Color the line is erased to
+ * Returns: Status line (free with status_text_free), or NULL on failure
+ */
+StatusText *status_text_create(const DisplayInfo *display_info, int rotation, int top,
+                               uint32_t color, uint32_t background);
+
+/* Replace the shown message; characters outside printable ASCII show as '?'
+ * Returns: 0 on success, -1 if the line could not be drawn (the old
+ *          message is erased anyway)
+ */
+int status_text_set(Framebuffer *fb, StatusText *text, const char *message);
+
+/* Draw the current message again, e.g. after the frame under it was repainted */
+void status_text_draw(Framebuffer *fb, const StatusText *text);
+
+/* Message on screen, "" when none is */
+const char *status_text_message(const StatusText *text);
+
+/* Free the atlas and the cached lines */
+void status_text_free(StatusText *text);
+
+#endif
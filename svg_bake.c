@@ -0,0 +1,81 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "svg_parser.h"
+#include "logo.h"
+
+/*
+ * Build-time geometry compiler
+ *
+ * Parses the logo path strings with the runtime parser and writes a C source
+ * file holding the parsed outlines (verbs, points with exact curve control
+ * points, and fill colors) in const storage, so the splash binary never has
+ * to parse at boot. Flattening is left to runtime, where the on-screen scale
+ * is known.
+ */
+
+/* Write the verb and point arrays of one outline */
+static void emit_outline(FILE *out, size_t index, const SVGOutline *outline)
+{
+    fprintf(out, "static const uint8_t path%zu_verbs[] = {", index);
+    for (uint32_t i = 0; i < outline->num_verbs; i++)
+    {
+        const char *separator = (i == 0) ? "\n    " : (i % 16) ? ", " : ",\n    ";
+        fprintf(out, "%s%u", separator, outline->verbs[i]);
+    }
+    fprintf(out, "\n};\n\n");
+
+    fprintf(out, "static const Point path%zu_points[] = {\n", index);
+    for (uint32_t i = 0; i < outline->num_points; i++)
+    {
+        // %.9e round-trips every float exactly
+        fprintf(out, "    {%.9ef, %.9ef},\n", outline->points[i].x, outline->points[i].y);
+    }
+    fprintf(out, "};\n\n");
+}
+
+int main(void)
+{
+    FILE *out = stdout;
+    SVGOutline **parsed = calloc(logo_num_paths, sizeof(SVGOutline *));
+    if (!parsed)
+    {
+        return 1;
+    }
+
+    fprintf(out, "/* Generated by svg_bake from logo.c - do not edit */\n");
+    fprintf(out, "#include \"logo.h\"\n\n");
+
+    for (size_t i = 0; i < logo_num_paths; i++)
+    {
+        parsed[i] = parse_svg_outline(svg_paths[i], svg_colors[i]);
+        if (!parsed[i])
+        {
+            fprintf(stderr, "svg_bake: failed to parse path %zu\n", i);
+            return 1;
+        }
+        emit_outline(out, i, parsed[i]);
+    }
+
+    fprintf(out, "const SVGOutline logo_geometry[] = {\n");
+    for (size_t i = 0; i < logo_num_paths; i++)
+    {
+        const SVGOutline *outline = parsed[i];
+        fprintf(out, "    {(uint8_t *)path%zu_verbs, %u, %u, (Point *)path%zu_points, %u, %u, {%u, %u, %u, %u}},\n",
+                i, outline->num_verbs, outline->num_verbs,
+                i, outline->num_points, outline->num_points,
+                outline->fill_color.r, outline->fill_color.g,
+                outline->fill_color.b, outline->fill_color.a);
+    }
+    fprintf(out, "};\n\n");
+    fprintf(out, "const size_t logo_geometry_count = %zu;\n", logo_num_paths);
+    fprintf(out, "const ViewBox logo_view_box = {%.9ef, %.9ef, %.9ef, %.9ef};\n",
+            svg_view_box.x, svg_view_box.y, svg_view_box.width, svg_view_box.height);
+
+    for (size_t i = 0; i < logo_num_paths; i++)
+    {
+        free_svg_outline(parsed[i]);
+    }
+    free(parsed);
+
+    return ferror(out) ? 1 : 0;
+}
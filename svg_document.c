@@ -0,0 +1,712 @@
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "svg_document.h"
+#include "svg_parser.h"
+#include "transform.h"
+
+/* Deepest <g> nesting that keeps its own transform and fill */
+#define MAX_GROUP_DEPTH 32
+
+#define INITIAL_CAPACITY 16
+
+/* Inherited drawing state of an open <g> */
+typedef struct
+{
+    Transform transform;  // User space of the group to document space
+    Color fill;           // Inherited fill color
+    bool filled;          // False when the inherited fill is none
+} GroupState;
+
+/* One attribute of a start tag, pointing into the document */
+typedef struct
+{
+    const char *name;
+    size_t name_length;
+    const char *value;
+    size_t value_length;
+} Attribute;
+
+/* Element kinds the loader cares about */
+typedef enum
+{
+    ELEMENT_OTHER,    // Ignored, but its children are still scanned
+    ELEMENT_SVG,      // Root element carrying the viewBox
+    ELEMENT_GROUP,    // <g>, scoping transform and fill
+    ELEMENT_PATH,     // <path>, drawn
+    ELEMENT_HIDDEN    // Container whose children are never drawn directly
+} ElementKind;
+
+/* Named colors accepted in fill */
+static const struct
+{
+    const char *name;
+    Color color;
+} named_colors[] = {
+    { "black", { 0, 0, 0, 255 } },
+    { "white", { 255, 255, 255, 255 } },
+    { "red", { 255, 0, 0, 255 } },
+    { "lime", { 0, 255, 0, 255 } },
+    { "green", { 0, 128, 0, 255 } },
+    { "blue", { 0, 0, 255, 255 } },
+    { "yellow", { 255, 255, 0, 255 } },
+    { "gray", { 128, 128, 128, 255 } },
+    { "grey", { 128, 128, 128, 255 } },
+};
+
+/* Containers whose content is referenced rather than rendered */
+static const char *const hidden_elements[] = {
+    "defs", "clipPath", "mask", "symbol", "marker", "pattern", NULL
+};
+
+static bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* Whether a counted string equals a NUL-terminated one */
+static bool equals(const char *s, size_t length, const char *literal)
+{
+    return strlen(literal) == length && memcmp(s, literal, length) == 0;
+}
+
+/* Trim surrounding whitespace from a counted string */
+static void trim(const char **s, size_t *length)
+{
+    while (*length > 0 && is_space(**s))
+    {
+        (*s)++;
+        (*length)--;
+    }
+    while (*length > 0 && is_space((*s)[*length - 1]))
+    {
+        (*length)--;
+    }
+}
+
+/* Parse up to max numbers separated by whitespace or commas
+ * Numbers are scanned as in path data, whatever the C locale.
+ * Returns: Count of numbers read
+ */
+static int scan_numbers(const char **pos, const char *end, float *values, int max)
+{
+    const char *p = *pos;
+    int count = 0;
+    while (count < max)
+    {
+        while (p < end && (is_space(*p) || *p == ','))
+            p++;
+        if (p >= end)
+            break;
+
+        const char *next = scan_svg_number(p, end, &values[count]);
+        if (!next)
+            break;
+        count++;
+        p = next;
+    }
+    *pos = p;
+    return count;
+}
+
+/* Value of a hexadecimal digit, or -1 */
+static int hex_digit(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+/* Parse a fill value into color or filled = false for none
+ * Returns: false for unsupported paints (gradients, currentColor), which inherit
+ */
+static bool parse_paint(const char *s, size_t length, Color *color, bool *filled)
+{
+    trim(&s, &length);
+
+    if (equals(s, length, "none"))
+    {
+        *filled = false;
+        return true;
+    }
+
+    if (length > 0 && s[0] == '#' && (length == 4 || length == 7))
+    {
+        int digits[6];
+        for (size_t i = 1; i < length; i++)
+        {
+            if ((digits[i - 1] = hex_digit(s[i])) < 0)
+                return false;
+        }
+        if (length == 4)
+        {
+            color->r = digits[0] * 17;
+            color->g = digits[1] * 17;
+            color->b = digits[2] * 17;
+        }
+        else
+        {
+            color->r = digits[0] * 16 + digits[1];
+            color->g = digits[2] * 16 + digits[3];
+            color->b = digits[4] * 16 + digits[5];
+        }
+        color->a = 255;
+        *filled = true;
+        return true;
+    }
+
+    if (length > 4 && memcmp(s, "rgb(", 4) == 0)
+    {
+        const char *p = s + 4;
+        float rgb[3];
+        if (scan_numbers(&p, s + length, rgb, 3) != 3)
+            return false;
+        color->r = rgb[0] < 0 ? 0 : rgb[0] > 255 ? 255 : (uint8_t)rgb[0];
+        color->g = rgb[1] < 0 ? 0 : rgb[1] > 255 ? 255 : (uint8_t)rgb[1];
+        color->b = rgb[2] < 0 ? 0 : rgb[2] > 255 ? 255 : (uint8_t)rgb[2];
+        color->a = 255;
+        *filled = true;
+        return true;
+    }
+
+    for (size_t i = 0; i < sizeof(named_colors) / sizeof(named_colors[0]); i++)
+    {
+        if (equals(s, length, named_colors[i].name))
+        {
+            *color = named_colors[i].color;
+            *filled = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Apply the fill declaration of a style attribute, if any */
+static void parse_style_fill(const char *s, size_t length, Color *color, bool *filled)
+{
+    const char *end = s + length;
+    while (s < end)
+    {
+        const char *semicolon = memchr(s, ';', end - s);
+        const char *decl_end = semicolon ? semicolon : end;
+        const char *colon = memchr(s, ':', decl_end - s);
+
+        if (colon)
+        {
+            const char *name = s;
+            size_t name_length = colon - s;
+            trim(&name, &name_length);
+            if (equals(name, name_length, "fill"))
+                parse_paint(colon + 1, decl_end - colon - 1, color, filled);
+        }
+        s = decl_end + 1;
+    }
+}
+
+/* Parse a transform list such as "translate(10 20) rotate(45)"
+ * Items apply right to left, as in SVG; an unknown item ends the list
+ */
+static Transform parse_transform(const char *s, size_t length)
+{
+    const char *p = s;
+    const char *end = s + length;
+    Transform result = transform_identity();
+
+    while (p < end)
+    {
+        while (p < end && (is_space(*p) || *p == ','))
+            p++;
+        const char *name = p;
+        while (p < end && *p != '(' && !is_space(*p))
+            p++;
+        size_t name_length = p - name;
+        while (p < end && is_space(*p))
+            p++;
+        if (name_length == 0 || p >= end || *p != '(')
+            break;
+        p++;
+
+        float v[6];
+        int count = scan_numbers(&p, end, v, 6);
+        while (p < end && *p != ')')
+            p++;
+        if (p >= end)
+            break;
+        p++;
+
+        Transform item;
+        if (equals(name, name_length, "matrix") && count == 6)
+        {
+            item = (Transform){ v[0], v[1], v[2], v[3], v[4], v[5] };
+        }
+        else if (equals(name, name_length, "translate") && count >= 1)
+        {
+            item = transform_translate(v[0], count >= 2 ? v[1] : 0.0f);
+        }
+        else if (equals(name, name_length, "scale") && count >= 1)
+        {
+            item = transform_scale(v[0], count >= 2 ? v[1] : v[0]);
+        }
+        else if (equals(name, name_length, "rotate") && count >= 1)
+        {
+            float radians = v[0] * (float)M_PI / 180.0f;
+            float cos_angle = cosf(radians);
+            float sin_angle = sinf(radians);
+            item = (Transform){ cos_angle, sin_angle, -sin_angle, cos_angle, 0.0f, 0.0f };
+            if (count >= 3)
+            {
+                // Rotate about (cx, cy)
+                Transform to_origin = transform_translate(-v[1], -v[2]);
+                Transform back = transform_translate(v[1], v[2]);
+                item = transform_multiply(&item, &to_origin);
+                item = transform_multiply(&back, &item);
+            }
+        }
+        else if (equals(name, name_length, "skewX") && count >= 1)
+        {
+            item = (Transform){ 1.0f, 0.0f, tanf(v[0] * (float)M_PI / 180.0f), 1.0f, 0.0f, 0.0f };
+        }
+        else if (equals(name, name_length, "skewY") && count >= 1)
+        {
+            item = (Transform){ 1.0f, tanf(v[0] * (float)M_PI / 180.0f), 0.0f, 1.0f, 0.0f, 0.0f };
+        }
+        else
+        {
+            break;
+        }
+        result = transform_multiply(&result, &item);
+    }
+    return result;
+}
+
+/* Read the next attribute of a start tag
+ * Returns: Position after it, or after the closing '>' with attr->name set to
+ *          NULL once the tag ends; NULL for a truncated tag
+ */
+static const char *next_attribute(const char *p, const char *end, Attribute *attr,
+                                  bool *self_closing)
+{
+    while (p < end && is_space(*p))
+        p++;
+    if (p >= end)
+        return NULL;
+
+    if (*p == '/' || *p == '>')
+    {
+        *self_closing = *p == '/';
+        const char *close = memchr(p, '>', end - p);
+        attr->name = NULL;
+        return close ? close + 1 : NULL;
+    }
+
+    attr->name = p;
+    while (p < end && *p != '=' && *p != '/' && *p != '>' && !is_space(*p))
+        p++;
+    attr->name_length = p - attr->name;
+    attr->value = NULL;
+    attr->value_length = 0;
+
+    while (p < end && is_space(*p))
+        p++;
+    if (p >= end || *p != '=')
+    {
+        // Valueless attribute; always make progress on stray characters
+        return attr->name_length ? p : p + 1;
+    }
+    p++;
+    while (p < end && is_space(*p))
+        p++;
+    if (p >= end || (*p != '"' && *p != '\''))
+        return NULL;
+
+    char quote = *p++;
+    const char *close = memchr(p, quote, end - p);
+    if (!close)
+        return NULL;
+    attr->value = p;
+    attr->value_length = close - p;
+    return close + 1;
+}
+
+/* Read an element name, dropping any namespace prefix
+ * Returns: Position after the name
+ */
+static const char *read_name(const char *p, const char *end, const char **name, size_t *length)
+{
+    const char *start = p;
+    while (p < end && !is_space(*p) && *p != '/' && *p != '>')
+    {
+        if (*p == ':')
+            start = p + 1;
+        p++;
+    }
+    *name = start;
+    *length = p - start;
+    return p;
+}
+
+/* Classify an element by name */
+static ElementKind element_kind(const char *name, size_t length)
+{
+    if (equals(name, length, "path"))
+        return ELEMENT_PATH;
+    if (equals(name, length, "g"))
+        return ELEMENT_GROUP;
+    if (equals(name, length, "svg"))
+        return ELEMENT_SVG;
+    for (int i = 0; hidden_elements[i]; i++)
+    {
+        if (equals(name, length, hidden_elements[i]))
+            return ELEMENT_HIDDEN;
+    }
+    return ELEMENT_OTHER;
+}
+
+/* Find the end tag closing an element named name
+ * Returns: Position after the end tag, or NULL if there is none
+ */
+static const char *skip_to_end_tag(const char *p, const char *end, const char *name, size_t length)
+{
+    while ((p = memmem(p, end - p, "</", 2)) != NULL)
+    {
+        const char *tag;
+        size_t tag_length;
+        p = read_name(p + 2, end, &tag, &tag_length);
+        if (tag_length == length && memcmp(tag, name, length) == 0)
+        {
+            const char *close = memchr(p, '>', end - p);
+            return close ? close + 1 : NULL;
+        }
+    }
+    return NULL;
+}
+
+/* Append a parsed outline, taking over its arrays */
+static bool add_outline(SVGDocument *doc, SVGOutline *outline)
+{
+    if (doc->num_outlines >= doc->capacity)
+    {
+        size_t capacity = doc->capacity ? doc->capacity * 2 : INITIAL_CAPACITY;
+        SVGOutline *outlines = realloc(doc->outlines, capacity * sizeof(SVGOutline));
+        if (!outlines)
+            return false;
+        doc->outlines = outlines;
+        doc->capacity = capacity;
+    }
+    doc->outlines[doc->num_outlines++] = *outline;
+    free(outline);
+    return true;
+}
+
+/* Parse the d attribute of a path into document space and append it
+ * Returns: false if memory ran out
+ */
+static bool add_path(SVGDocument *doc, const Attribute *d, const Transform *transform,
+                     Color fill)
+{
+    SVGOutline *outline = parse_svg_outline_data(d->value, d->value_length, fill);
+    if (!outline)
+        return false;
+    if (outline->num_verbs == 0)
+    {
+        free_svg_outline(outline);
+        return true;
+    }
+
+    // Affine maps keep Bezier curves exact, so control points map like any other
+    for (uint32_t i = 0; i < outline->num_points; i++)
+        outline->points[i] = transform_point(transform, outline->points[i]);
+
+    if (!add_outline(doc, outline))
+    {
+        free_svg_outline(outline);
+        return false;
+    }
+    return true;
+}
+
+/* View box covering every point, for documents that declare none */
+static bool bounds_view_box(const SVGDocument *doc, ViewBox *view_box)
+{
+    float min_x = INFINITY, min_y = INFINITY;
+    float max_x = -INFINITY, max_y = -INFINITY;
+    for (size_t i = 0; i < doc->num_outlines; i++)
+    {
+        const SVGOutline *outline = &doc->outlines[i];
+        for (uint32_t j = 0; j < outline->num_points; j++)
+        {
+            min_x = fminf(min_x, outline->points[j].x);
+            min_y = fminf(min_y, outline->points[j].y);
+            max_x = fmaxf(max_x, outline->points[j].x);
+            max_y = fmaxf(max_y, outline->points[j].y);
+        }
+    }
+    if (!(max_x > min_x && max_y > min_y))
+        return false;
+
+    *view_box = (ViewBox){ min_x, min_y, max_x - min_x, max_y - min_y };
+    return true;
+}
+
+#ifdef SPLASH_FIXED_POINT
+/* Scale the document by a power of two until its points and view box fit
+ * the +-FIXED_PATH_LIMIT range of fixed-point path coordinates
+ * Scaling points and view box alike leaves the drawn picture unchanged, and
+ * a power of two keeps every float exact.
+ */
+static void fit_fixed_range(SVGDocument *doc)
+{
+    const ViewBox *vb = &doc->view_box;
+    float extent = fmaxf(fmaxf(fabsf(vb->x), fabsf(vb->y)),
+                         fmaxf(fabsf(vb->x + vb->width), fabsf(vb->y + vb->height)));
+    for (size_t i = 0; i < doc->num_outlines; i++)
+    {
+        const SVGOutline *outline = &doc->outlines[i];
+        for (uint32_t j = 0; j < outline->num_points; j++)
+            extent = fmaxf(extent, fmaxf(fabsf(outline->points[j].x),
+                                         fabsf(outline->points[j].y)));
+    }
+
+    float scale = 1.0f;
+    while (extent * scale > FIXED_PATH_LIMIT && scale > 0x1p-64f)
+        scale *= 0.5f;
+    if (scale == 1.0f)
+        return;
+
+    for (size_t i = 0; i < doc->num_outlines; i++)
+    {
+        SVGOutline *outline = &doc->outlines[i];
+        for (uint32_t j = 0; j < outline->num_points; j++)
+        {
+            outline->points[j].x *= scale;
+            outline->points[j].y *= scale;
+        }
+    }
+    doc->view_box = (ViewBox){ vb->x * scale, vb->y * scale,
+                               vb->width * scale, vb->height * scale };
+}
+#endif
+
+/* Parse an SVG document held in memory */
+SVGDocument *svg_document_parse(const char *data, size_t size)
+{
+    SVGDocument *doc = calloc(1, sizeof(SVGDocument));
+    if (!doc)
+        return NULL;
+
+    GroupState stack[MAX_GROUP_DEPTH];
+    int depth = 0;          // Index of the innermost tracked group
+    int untracked = 0;      // Open groups nested beyond MAX_GROUP_DEPTH
+    stack[0] = (GroupState){ transform_identity(), { 0, 0, 0, 255 }, true };
+
+    bool have_view_box = false;
+    float svg_width = 0.0f, svg_height = 0.0f;
+    bool ok = true;
+
+    const char *p = data;
+    const char *end = data + size;
+
+    while (ok && p < end && (p = memchr(p, '<', end - p)) != NULL)
+    {
+        p++;
+        if (end - p >= 3 && memcmp(p, "!--", 3) == 0)
+        {
+            p = memmem(p, end - p, "-->", 3);
+            if (!p)
+                break;
+            p += 3;
+            continue;
+        }
+        if (p < end && (*p == '!' || *p == '?'))
+        {
+            // Declarations and processing instructions
+            p = memchr(p, '>', end - p);
+            if (!p)
+                break;
+            p++;
+            continue;
+        }
+
+        const char *name;
+        size_t name_length;
+        if (p < end && *p == '/')
+        {
+            p = read_name(p + 1, end, &name, &name_length);
+            if (equals(name, name_length, "g"))
+            {
+                if (untracked > 0)
+                    untracked--;
+                else if (depth > 0)
+                    depth--;
+            }
+            continue;
+        }
+
+        p = read_name(p, end, &name, &name_length);
+        ElementKind kind = element_kind(name, name_length);
+
+        Attribute d = { NULL, 0, NULL, 0 };
+        Attribute fill = d, style = d, transform = d, view_box = d, width = d, height = d;
+        bool self_closing = false;
+        Attribute attr;
+        while ((p = next_attribute(p, end, &attr, &self_closing)) != NULL && attr.name)
+        {
+            if (!attr.value)
+                continue;
+            if (equals(attr.name, attr.name_length, "d"))
+                d = attr;
+            else if (equals(attr.name, attr.name_length, "fill"))
+                fill = attr;
+            else if (equals(attr.name, attr.name_length, "style"))
+                style = attr;
+            else if (equals(attr.name, attr.name_length, "transform"))
+                transform = attr;
+            else if (equals(attr.name, attr.name_length, "viewBox"))
+                view_box = attr;
+            else if (equals(attr.name, attr.name_length, "width"))
+                width = attr;
+            else if (equals(attr.name, attr.name_length, "height"))
+                height = attr;
+        }
+        if (!p)
+            break;
+
+        // Drawing state of this element: inherited, then own attributes
+        GroupState state = stack[depth];
+        if (transform.value)
+        {
+            Transform own = parse_transform(transform.value, transform.value_length);
+            state.transform = transform_multiply(&stack[depth].transform, &own);
+        }
+        if (fill.value)
+            parse_paint(fill.value, fill.value_length, &state.fill, &state.filled);
+        if (style.value)
+            parse_style_fill(style.value, style.value_length, &state.fill, &state.filled);
+
+        switch (kind)
+        {
+            case ELEMENT_SVG:
+                if (!have_view_box && view_box.value)
+                {
+                    const char *v = view_box.value;
+                    float box[4];
+                    if (scan_numbers(&v, v + view_box.value_length, box, 4) == 4 &&
+                        box[2] > 0.0f && box[3] > 0.0f)
+                    {
+                        doc->view_box = (ViewBox){ box[0], box[1], box[2], box[3] };
+                        have_view_box = true;
+                    }
+                }
+                if (width.value && height.value && svg_width == 0.0f)
+                {
+                    const char *w = width.value;
+                    const char *h = height.value;
+                    scan_numbers(&w, w + width.value_length, &svg_width, 1);
+                    scan_numbers(&h, h + height.value_length, &svg_height, 1);
+                }
+                // The root fill is inherited by everything below it
+                stack[depth].fill = state.fill;
+                stack[depth].filled = state.filled;
+                break;
+
+            case ELEMENT_GROUP:
+                if (self_closing)
+                    break;
+                if (depth + 1 < MAX_GROUP_DEPTH)
+                    stack[++depth] = state;
+                else
+                    untracked++;
+                break;
+
+            case ELEMENT_PATH:
+                if (d.value && state.filled)
+                    ok = add_path(doc, &d, &state.transform, state.fill);
+                break;
+
+            case ELEMENT_HIDDEN:
+                if (!self_closing)
+                {
+                    // An unclosed container hides the rest of the document
+                    const char *after = skip_to_end_tag(p, end, name, name_length);
+                    p = after ? after : end;
+                }
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    if (ok && doc->num_outlines > 0 && !have_view_box)
+    {
+        if (svg_width > 0.0f && svg_height > 0.0f)
+        {
+            doc->view_box = (ViewBox){ 0.0f, 0.0f, svg_width, svg_height };
+            have_view_box = true;
+        }
+        else
+        {
+            have_view_box = bounds_view_box(doc, &doc->view_box);
+        }
+    }
+
+    if (!ok || doc->num_outlines == 0 || !have_view_box)
+    {
+        svg_document_free(doc);
+        return NULL;
+    }
+#ifdef SPLASH_FIXED_POINT
+    fit_fixed_range(doc);
+#endif
+    return doc;
+}
+
+/* Map an SVG file read-only and parse it in place */
+SVGDocument *svg_document_load(const char *path)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1)
+        return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    // Prefault the whole file: it is read once, front to back
+    size_t size = st.st_size;
+    void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+        return NULL;
+
+    SVGDocument *doc = svg_document_parse(map, size);
+    munmap(map, size);
+    return doc;
+}
+
+/* Free a document and every outline it holds */
+void svg_document_free(SVGDocument *doc)
+{
+    if (!doc)
+        return;
+
+    for (size_t i = 0; i < doc->num_outlines; i++)
+    {
+        free(doc->outlines[i].verbs);
+        free(doc->outlines[i].points);
+    }
+    free(doc->outlines);
+    free(doc);
+}
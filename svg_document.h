@@ -0,0 +1,43 @@
+#ifndef SVG_DOCUMENT_H
+#define SVG_DOCUMENT_H
+
+#include <stddef.h>
+#include "svg_types.h"
+
+/* Filled paths of an SVG file, ready for flattening
+ * outlines: One per drawn <path> in document (painter's) order, with the
+ *           path and group transforms already applied to the points
+ * view_box: User-space area the document draws in
+ */
+typedef struct {
+    SVGOutline *outlines;
+    size_t num_outlines;
+    size_t capacity;
+    ViewBox view_box;
+} SVGDocument;
+
+/* Load the paths of an SVG file
+ * The file is mapped read-only and scanned once; path data and attribute
+ * values are parsed where they lie in the mapping, without a DOM or copies.
+ * Understood: the <svg> viewBox (else its width and height, else the bounds
+ * of the paths), <g> and <path> elements with fill, style="fill:..." and
+ * transform attributes. Fills are #rgb, #rrggbb, rgb(r,g,b), none or a basic
+ * color name; anything else inherits. Content of defs, clipPath, mask,
+ * symbol, marker and pattern elements is not drawn. Fixed-point builds hold
+ * path coordinates within +-FIXED_PATH_LIMIT units, so a document reaching
+ * beyond that is scaled down by a power of two, view box included; it draws
+ * the same, but its coordinates no longer match the file.
+ * Returns: New document (free with svg_document_free) or NULL if the file
+ *          cannot be read or draws nothing
+ */
+SVGDocument *svg_document_load(const char *path);
+
+/* Parse an SVG document held in memory, as svg_document_load does
+ * data need not be NUL-terminated
+ */
+SVGDocument *svg_document_parse(const char *data, size_t size);
+
+/* Free a document and its outlines */
+void svg_document_free(SVGDocument *doc);
+
+#endif
@@ -0,0 +1,171 @@
+#include <locale.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "fixed_point.h"
+#include "svg_document.h"
+#include "svg_flatten.h"
+
+/*
+ * Document loader checks
+ *
+ * Parses small documents held in memory and checks what the loader makes
+ * of them, malformed ones included. Run with make check.
+ */
+
+static int failures;
+
+/* Report a failed expectation */
+#define CHECK(cond)                                                            \
+    do                                                                         \
+    {                                                                          \
+        if (!(cond))                                                           \
+        {                                                                      \
+            fprintf(stderr, "%s:%d: %s: check failed: %s\n", __FILE__,         \
+                    __LINE__, __func__, #cond);                                \
+            failures++;                                                        \
+        }                                                                      \
+    } while (0)
+
+/* Parse a NUL-terminated document without its terminator */
+static SVGDocument *parse(const char *text)
+{
+    return svg_document_parse(text, strlen(text));
+}
+
+/* A hidden container that is never closed hides the rest of the document,
+ * but what came before it is still drawn
+ */
+static void test_unclosed_hidden_element(void)
+{
+    SVGDocument *doc = parse("<svg viewBox=\"0 0 10 10\"><path d=\"M0 0 L10 0 L10 10z\"/>"
+                             "<defs><path d=\"M1 1\"/>");
+    CHECK(doc != NULL);
+    if (doc)
+    {
+        CHECK(doc->num_outlines == 1);
+        CHECK(doc->view_box.width == 10.0f && doc->view_box.height == 10.0f);
+    }
+    svg_document_free(doc);
+
+    // Nothing drawn before the container: no document
+    CHECK(parse("<svg viewBox=\"0 0 10 10\"><clipPath><path d=\"M0 0 L1 1\"/>") == NULL);
+}
+
+/* A closed hidden container is skipped and drawing resumes after it */
+static void test_closed_hidden_element(void)
+{
+    SVGDocument *doc = parse("<svg viewBox=\"0 0 10 10\"><defs><path d=\"M1 1 L2 2 L1 2z\"/></defs>"
+                             "<path d=\"M0 0 L10 0 L10 10z\"/></svg>");
+    CHECK(doc != NULL);
+    if (doc)
+    {
+        CHECK(doc->num_outlines == 1);
+    }
+    svg_document_free(doc);
+}
+
+/* Sub-paths side by side are all filled; nested ones alternate between
+ * hole and fill, whatever their order in the path data
+ */
+static void test_sub_path_holes(void)
+{
+    SVGDocument *doc = parse("<svg viewBox=\"0 0 100 40\">"
+                             "<path d=\"M0 0 h40 v40 h-40 z M60 0 h40 v40 h-40 z\"/>"
+                             "<path d=\"M75 15 h10 v10 h-10 z M70 10 h20 v20 h-20 z M60 0 h40 v40 h-40 z\"/>"
+                             "</svg>");
+    Arena *arena = arena_create(4096);
+    CHECK(doc != NULL && arena != NULL);
+    if (doc && arena)
+    {
+        CHECK(doc->num_outlines == 2);
+        SVGPath *side_by_side = flatten_svg_outline(&doc->outlines[0], DEFAULT_FLATTEN_TOLERANCE, arena);
+        CHECK(side_by_side != NULL);
+        if (side_by_side)
+        {
+            CHECK(side_by_side->num_paths == 2);
+            CHECK(!side_by_side->paths[0].is_hole && !side_by_side->paths[1].is_hole);
+        }
+
+        SVGPath *nested = flatten_svg_outline(&doc->outlines[1], DEFAULT_FLATTEN_TOLERANCE, arena);
+        CHECK(nested != NULL);
+        if (nested)
+        {
+            CHECK(nested->num_paths == 3);
+            CHECK(!nested->paths[0].is_hole && nested->paths[1].is_hole && !nested->paths[2].is_hole);
+        }
+    }
+    arena_destroy(arena);
+    svg_document_free(doc);
+}
+
+/* Coordinates beyond the fixed-point range are scaled into it, view box
+ * and all, in fixed-point builds and kept as written otherwise
+ */
+static void test_large_coordinates(void)
+{
+    SVGDocument *doc = parse("<svg viewBox=\"0 0 100000 50000\">"
+                             "<path d=\"M0 0 L100000 0 L100000 50000z\"/></svg>");
+    CHECK(doc != NULL);
+    if (doc)
+    {
+        const ViewBox *vb = &doc->view_box;
+        const Point *corner = &doc->outlines[0].points[2];
+#ifdef SPLASH_FIXED_POINT
+        CHECK(vb->width <= FIXED_PATH_LIMIT && vb->width == 2.0f * vb->height);
+        CHECK(corner->x == vb->width && corner->y == vb->height);
+#else
+        CHECK(vb->width == 100000.0f && vb->height == 50000.0f);
+        CHECK(corner->x == 100000.0f && corner->y == 50000.0f);
+#endif
+    }
+    svg_document_free(doc);
+}
+
+/* Decimal fractions in attributes parse the same whatever LC_NUMERIC says
+ * Skipped, with a message, when no comma-decimal locale is installed.
+ */
+static void test_numbers_ignore_locale(void)
+{
+    const char *locales[] = { "de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR" };
+    bool comma_decimal = false;
+    for (size_t i = 0; i < sizeof(locales) / sizeof(locales[0]) && !comma_decimal; i++)
+    {
+        if (setlocale(LC_NUMERIC, locales[i]))
+            comma_decimal = localeconv()->decimal_point[0] == ',';
+    }
+    if (!comma_decimal)
+    {
+        setlocale(LC_NUMERIC, "C");
+        printf("%s: skipped, no comma-decimal locale installed\n", __func__);
+        return;
+    }
+
+    SVGDocument *doc = parse("<svg viewBox=\"0.5,0.25 10.5 20.75\">"
+                             "<path d=\"M0 0 L10 0 L10 10z\"/></svg>");
+    CHECK(doc != NULL);
+    if (doc)
+    {
+        CHECK(doc->view_box.x == 0.5f && doc->view_box.y == 0.25f);
+        CHECK(doc->view_box.width == 10.5f && doc->view_box.height == 20.75f);
+    }
+    svg_document_free(doc);
+    setlocale(LC_NUMERIC, "C");
+}
+
+int main(void)
+{
+    test_unclosed_hidden_element();
+    test_closed_hidden_element();
+    test_sub_path_holes();
+    test_large_coordinates();
+    test_numbers_ignore_locale();
+
+    if (failures)
+    {
+        fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("svg_document: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,348 @@
+#include <math.h>
+#include "svg_flatten.h"
+#include "fixed_point.h"
+
+#define MAX_CURVE_SEGMENTS 1024
+
+#ifdef SPLASH_FIXED_POINT
+/* Fraction bits of the curve parameter t in fixed-point builds */
+#define CURVE_T_SHIFT 24
+#endif
+
+/* Flattening output
+ * Run once with NULL arrays to count points and sub-paths, then again to
+ * store them, so the geometry is allocated once at its exact size. The
+ * counting run records each cubic's segment count for the storing run.
+ */
+typedef struct {
+    PathPoint *points;       // Point storage, or NULL while counting
+    Path *paths;             // Sub-path storage, or NULL while counting
+    uint16_t *segments;      // Segment count of each cubic
+    uint32_t num_cubics;     // Cubics seen so far
+    uint32_t num_points;     // Points emitted so far
+    uint32_t num_paths;      // Sub-paths emitted so far
+    uint32_t path_start;     // First point of the current sub-path
+} Flattener;
+
+/* Append a point to the current sub-path */
+static inline void emit_point(Flattener *f, PathPoint point) {
+    if (f->points) {
+        f->points[f->num_points] = point;
+    }
+    f->num_points++;
+}
+
+/* Finish the current sub-path, dropping it if it never received points
+ * Holes are marked once every sub-path is known, see mark_holes()
+ */
+static void end_path(Flattener *f) {
+    if (f->num_points == f->path_start) return;
+
+    if (f->paths) {
+        Path *path = &f->paths[f->num_paths];
+        path->offset = f->path_start;
+        path->num_points = f->num_points - f->path_start;
+        path->is_hole = false;
+    }
+    f->num_paths++;
+    f->path_start = f->num_points;
+}
+
+/* Outline point in the coordinates of flattened paths */
+static inline PathPoint to_path_point(Point p) {
+#ifdef SPLASH_FIXED_POINT
+    PathPoint r = { coord_from_float(p.x), coord_from_float(p.y) };
+    return r;
+#else
+    return p;
+#endif
+}
+
+#ifdef SPLASH_FIXED_POINT
+/* Integer square root, rounded down */
+static uint64_t isqrt64(uint64_t v) {
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/* Number of line segments keeping a cubic within tolerance (Wang's formula)
+ * n = sqrt(3/4 * max|second difference of control points| / tolerance),
+ * in integers: the differences are squared at 24.8 so the sums fit in
+ * 64 bits, and both roots are integer square roots.
+ */
+static uint32_t cubic_segments(PathPoint p0, PathPoint p1, PathPoint p2, PathPoint p3,
+                               PathCoord tolerance) {
+    int64_t ax = ((int64_t)p0.x - 2 * (int64_t)p1.x + p2.x) >> 8;
+    int64_t ay = ((int64_t)p0.y - 2 * (int64_t)p1.y + p2.y) >> 8;
+    int64_t bx = ((int64_t)p1.x - 2 * (int64_t)p2.x + p3.x) >> 8;
+    int64_t by = ((int64_t)p1.y - 2 * (int64_t)p2.y + p3.y) >> 8;
+    uint64_t ma = (uint64_t)(ax * ax + ay * ay);
+    uint64_t mb = (uint64_t)(bx * bx + by * by);
+
+    // Length in 16.16, then n squared rounded up
+    uint64_t length = isqrt64(ma > mb ? ma : mb) << 8;
+    uint64_t n2 = (3 * length + 4 * (uint64_t)tolerance - 1) / (4 * (uint64_t)tolerance);
+    if (n2 > (uint64_t)MAX_CURVE_SEGMENTS * MAX_CURVE_SEGMENTS) return MAX_CURVE_SEGMENTS;
+
+    uint64_t n = isqrt64(n2);
+    if (n * n < n2) n++;
+    return n < 1 ? 1 : (uint32_t)n;
+}
+
+/* Value of one coordinate of a cubic a t^3 + b t^2 + c t + d by Horner's
+ * rule, for t in CURVE_T_SHIFT fixed point
+ */
+static inline PathCoord cubic_at(int64_t a, int64_t b, int64_t c, PathCoord d, int64_t t) {
+    int64_t v = ((a * t) >> CURVE_T_SHIFT) + b;
+    v = ((v * t) >> CURVE_T_SHIFT) + c;
+    return (PathCoord)(((v * t) >> CURVE_T_SHIFT) + d);
+}
+
+/* Append a cubic Bezier curve starting at p0, excluding p0 itself
+ * Fixed-point forward differences would accumulate rounding over up to
+ * MAX_CURVE_SEGMENTS steps, so each point is evaluated on its own; the end
+ * point is exact. The counting run only sizes the curve.
+ */
+static void flatten_cubic(Flattener *f, PathPoint p0, PathPoint p1, PathPoint p2, PathPoint p3,
+                          PathCoord tolerance) {
+    if (!f->points) {
+        uint32_t n = cubic_segments(p0, p1, p2, p3, tolerance);
+        f->segments[f->num_cubics++] = (uint16_t)n;
+        f->num_points += n;
+        return;
+    }
+
+    uint32_t n = f->segments[f->num_cubics++];
+    int64_t step = (((int64_t)1 << CURVE_T_SHIFT) + n / 2) / n;
+
+    // Polynomial coefficients: B(t) = a t^3 + b t^2 + c t + p0
+    int64_t ax = -(int64_t)p0.x + 3 * (int64_t)p1.x - 3 * (int64_t)p2.x + p3.x;
+    int64_t ay = -(int64_t)p0.y + 3 * (int64_t)p1.y - 3 * (int64_t)p2.y + p3.y;
+    int64_t bx = 3 * (int64_t)p0.x - 6 * (int64_t)p1.x + 3 * (int64_t)p2.x;
+    int64_t by = 3 * (int64_t)p0.y - 6 * (int64_t)p1.y + 3 * (int64_t)p2.y;
+    int64_t cx = 3 * ((int64_t)p1.x - p0.x);
+    int64_t cy = 3 * ((int64_t)p1.y - p0.y);
+
+    int64_t t = 0;
+    for (uint32_t i = 1; i < n; i++) {
+        t += step;
+        PathPoint point = { cubic_at(ax, bx, cx, p0.x, t), cubic_at(ay, by, cy, p0.y, t) };
+        emit_point(f, point);
+    }
+    emit_point(f, p3);
+}
+#else
+/* Number of line segments keeping a cubic within tolerance (Wang's formula)
+ * n = sqrt(3/4 * max|second difference of control points| / tolerance)
+ */
+static uint32_t cubic_segments(Point p0, Point p1, Point p2, Point p3, float tolerance) {
+    float ax = p0.x - 2 * p1.x + p2.x;
+    float ay = p0.y - 2 * p1.y + p2.y;
+    float bx = p1.x - 2 * p2.x + p3.x;
+    float by = p1.y - 2 * p2.y + p3.y;
+    float m = fmaxf(ax * ax + ay * ay, bx * bx + by * by);
+
+    float n = ceilf(sqrtf(0.75f * sqrtf(m) / tolerance));
+    if (n < 1) return 1;
+    if (n > MAX_CURVE_SEGMENTS) return MAX_CURVE_SEGMENTS;
+    return (uint32_t)n;
+}
+
+/* Append a cubic Bezier curve starting at p0, excluding p0 itself
+ * Evaluates the polynomial by forward differencing; the end point is exact.
+ * The counting run only sizes the curve.
+ */
+static void flatten_cubic(Flattener *f, Point p0, Point p1, Point p2, Point p3, float tolerance) {
+    if (!f->points) {
+        uint32_t n = cubic_segments(p0, p1, p2, p3, tolerance);
+        f->segments[f->num_cubics++] = (uint16_t)n;
+        f->num_points += n;
+        return;
+    }
+
+    uint32_t n = f->segments[f->num_cubics++];
+    float h = 1.0f / n;
+    float h2 = h * h;
+    float h3 = h2 * h;
+
+    // Polynomial coefficients: B(t) = a t^3 + b t^2 + c t + p0
+    float ax = -p0.x + 3 * p1.x - 3 * p2.x + p3.x;
+    float ay = -p0.y + 3 * p1.y - 3 * p2.y + p3.y;
+    float bx = 3 * p0.x - 6 * p1.x + 3 * p2.x;
+    float by = 3 * p0.y - 6 * p1.y + 3 * p2.y;
+    float cx = 3 * (p1.x - p0.x);
+    float cy = 3 * (p1.y - p0.y);
+
+    // First, second and third forward differences at t = 0
+    float dx = ax * h3 + bx * h2 + cx * h;
+    float dy = ay * h3 + by * h2 + cy * h;
+    float ddx = 6 * ax * h3 + 2 * bx * h2;
+    float ddy = 6 * ay * h3 + 2 * by * h2;
+    float dddx = 6 * ax * h3;
+    float dddy = 6 * ay * h3;
+
+    Point point = p0;
+    for (uint32_t i = 1; i < n; i++) {
+        point.x += dx;
+        point.y += dy;
+        dx += ddx;
+        dy += ddy;
+        ddx += dddx;
+        ddy += dddy;
+        emit_point(f, point);
+    }
+    emit_point(f, p3);
+}
+#endif
+
+/* Walk the outline's verbs, emitting one polygon per sub-path */
+static void flatten_verbs(Flattener *f, const SVGOutline *outline, PathCoord tolerance) {
+    const Point *pt = outline->points;
+    PathPoint start = {0, 0};
+    PathPoint current = {0, 0};
+
+    for (uint32_t i = 0; i < outline->num_verbs; i++) {
+        switch ((PathVerb)outline->verbs[i]) {
+            case PATH_MOVE:
+                // Every sub-path begins with a move
+                end_path(f);
+                start = current = to_path_point(pt[0]);
+                emit_point(f, current);
+                pt += 1;
+                break;
+
+            case PATH_LINE:
+                current = to_path_point(pt[0]);
+                emit_point(f, current);
+                pt += 1;
+                break;
+
+            case PATH_CUBIC: {
+                PathPoint end = to_path_point(pt[2]);
+                flatten_cubic(f, current, to_path_point(pt[0]), to_path_point(pt[1]), end,
+                              tolerance);
+                current = end;
+                pt += 3;
+                break;
+            }
+
+            case PATH_CLOSE:
+                if (f->num_points > f->path_start) {
+                    emit_point(f, start);
+                }
+                break;
+        }
+    }
+    end_path(f);
+}
+
+/* Flatten an outline into one polygon per sub-path */
+/* Bounding box of a sub-path */
+typedef struct {
+    PathCoord x0, y0;
+    PathCoord x1, y1;
+} PathBox;
+
+/* Whether p lies inside a closed sub-path, by the even-odd rule
+ * A crossing counts when p lies strictly left of an edge spanning its row;
+ * the sign test needs no division.
+ */
+static bool path_contains(const PathPoint *points, uint32_t count, PathPoint p) {
+    bool inside = false;
+    PathPoint a = points[count - 1];
+    for (uint32_t i = 0; i < count; i++) {
+        PathPoint b = points[i];
+        if ((b.y > p.y) != (a.y > p.y)) {
+            float ax = coord_to_float(a.x), ay = coord_to_float(a.y);
+            float side = (coord_to_float(b.x) - ax) * (coord_to_float(p.y) - ay) -
+                         (coord_to_float(p.x) - ax) * (coord_to_float(b.y) - ay);
+            if (b.y > a.y ? side > 0 : side < 0) inside = !inside;
+        }
+        a = b;
+    }
+    return inside;
+}
+
+/* Mark the holes of a flattened path by how its sub-paths nest
+ * A sub-path lying inside an odd number of the others is a hole, so
+ * sub-paths side by side are all filled and nested ones alternate, as the
+ * even-odd rule fills non-crossing sub-paths. Each sub-path is placed by
+ * its first point; bounding boxes rule out most pairs.
+ * Returns: false if the arena ran out of memory
+ */
+static bool mark_holes(SVGPath *svg, Arena *arena) {
+    if (svg->num_paths < 2) return true;
+
+    PathBox *boxes = arena_alloc_array(arena, svg->num_paths, sizeof(PathBox));
+    if (!boxes) return false;
+    for (uint32_t i = 0; i < svg->num_paths; i++) {
+        const PathPoint *points = path_points(svg, &svg->paths[i]);
+        PathBox box = { points[0].x, points[0].y, points[0].x, points[0].y };
+        for (uint32_t j = 1; j < svg->paths[i].num_points; j++) {
+            if (points[j].x < box.x0) box.x0 = points[j].x;
+            if (points[j].x > box.x1) box.x1 = points[j].x;
+            if (points[j].y < box.y0) box.y0 = points[j].y;
+            if (points[j].y > box.y1) box.y1 = points[j].y;
+        }
+        boxes[i] = box;
+    }
+
+    for (uint32_t i = 0; i < svg->num_paths; i++) {
+        PathPoint p = path_points(svg, &svg->paths[i])[0];
+        bool hole = false;
+        for (uint32_t j = 0; j < svg->num_paths; j++) {
+            const PathBox *box = &boxes[j];
+            if (j == i || p.x < box->x0 || p.x > box->x1 || p.y < box->y0 || p.y > box->y1) continue;
+            if (path_contains(path_points(svg, &svg->paths[j]), svg->paths[j].num_points, p)) {
+                hole = !hole;
+            }
+        }
+        svg->paths[i].is_hole = hole;
+    }
+    return true;
+}
+
+SVGPath* flatten_svg_outline(const SVGOutline *outline, float tolerance, Arena *arena) {
+    if (!(tolerance > 0)) {
+        tolerance = DEFAULT_FLATTEN_TOLERANCE;
+    }
+    PathCoord tol = coord_from_float(tolerance);
+#ifdef SPLASH_FIXED_POINT
+    // Below the coordinate resolution, the resolution is the tolerance
+    if (tol < 1) tol = 1;
+#endif
+
+    // Every verb could be a cubic
+    Flattener count = {0};
+    count.segments = arena_alloc_array(arena, outline->num_verbs, sizeof(uint16_t));
+    if (!count.segments) return NULL;
+    flatten_verbs(&count, outline, tol);
+
+    SVGPath *svg = arena_alloc(arena, sizeof(SVGPath));
+    Flattener store = {0};
+    store.segments = count.segments;
+    store.points = arena_alloc_array(arena, count.num_points, sizeof(PathPoint));
+    store.paths = arena_alloc_array(arena, count.num_paths, sizeof(Path));
+    if (!svg || !store.points || !store.paths) return NULL;
+
+    flatten_verbs(&store, outline, tol);
+
+    svg->points = store.points;
+    svg->num_points = store.num_points;
+    svg->paths = store.paths;
+    svg->num_paths = store.num_paths;
+    svg->fill_color = outline->fill_color;
+    return mark_holes(svg, arena) ? svg : NULL;
+}
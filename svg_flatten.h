@@ -0,0 +1,31 @@
+#ifndef SVG_FLATTEN_H
+#define SVG_FLATTEN_H
+
+#include "svg_types.h"
+#include "arena.h"
+
+/* Flattening tolerance in path units when the output scale is unknown */
+#define DEFAULT_FLATTEN_TOLERANCE 0.25f
+
+/* Maximum deviation in screen pixels between a curve and its flattened polyline */
+#define SCREEN_FLATTEN_TOLERANCE 0.2f
+
+/* Flatten an SVGOutline into polygons for rendering
+ * Each cubic gets just enough segments to stay within tolerance of the exact
+ * curve (Wang's formula) and is evaluated by forward differencing.
+ * Sub-paths nested inside an odd number of others become holes, the rest
+ * are filled, whatever their order or direction: the even-odd fill of
+ * sub-paths that do not cross. Nested sub-paths drawn in the same
+ * direction under fill-rule nonzero are filled as even-odd as well.
+ * The outline is walked twice, first to count, so the SVGPath, its points
+ * and its sub-path descriptors are exact-size arena allocations; small
+ * arrays of per-cubic segment counts and sub-path bounds are left in the
+ * arena as well.
+ * tolerance: Maximum deviation in path units, usually
+ *            SCREEN_FLATTEN_TOLERANCE divided by the render scale
+ * arena: Arena owning the result; it is freed with the arena
+ * Returns: Pointer to a new SVGPath or NULL if the arena ran out of memory
+ */
+SVGPath* flatten_svg_outline(const SVGOutline *outline, float tolerance, Arena *arena);
+
+#endif
@@ -1,246 +1,508 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <ctype.h>
+#include <math.h>
 #include "svg_parser.h"
+#include "svg_flatten.h"
 
 #define INITIAL_CAPACITY 100
-#define MAX_SUBPATHS 10
 
-/* Track current position during path parsing */
-static Point current_point = {0, 0};
-static Point start_point = {0, 0};
+/* Exactly representable powers of ten for the number scanner */
+static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
 
-/* Structure to handle compound paths with holes */
+/* Powers of ten exact in single precision, for the common short-number case */
+static const float float_powers_of_ten[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+/* Largest mantissa converted to float exactly */
+#define MAX_EXACT_FLOAT_MANTISSA (1u << 24)
+
+/* Significant digits kept by the number scanner; more cannot change a float */
+#define MAX_MANTISSA_DIGITS 19
+
+/* Per-call tokenizer state, so paths can be parsed concurrently */
 typedef struct {
-    Path paths[MAX_SUBPATHS];
-    int num_paths;
-} CompoundPath;
+    const char *p;           // Next unread byte
+    const char *end;         // One past the last byte of the path data
+    Point current;           // Current point
+    Point start;             // Start of the current sub-path, target of Z
+    Point control;           // Last control point, reflected by S and T
+    char previous;           // Previous command in upper case, 0 at the start
+    bool open;               // A sub-path has been started and not closed
+    SVGOutline *outline;     // Outline being built
+} PathParser;
+
+/* SVG whitespace (the C locale is never consulted) */
+static inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
 
-/* Parse a floating point number from a string
- * Advances the string pointer past the parsed number
- */
-static float parse_number(const char **str) {
-    // Skip whitespace and commas
-    while (isspace(**str) || **str == ',') (*str)++;
+static inline bool is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
 
-    char *end;
-    float num = strtof(*str, &end);
-    *str = end;
-    return num;
+/* Skip whitespace and comma separators */
+static void skip_separators(PathParser *ps) {
+    while (ps->p < ps->end && (is_space(*ps->p) || *ps->p == ',')) ps->p++;
 }
 
-/* Add a point to a path, growing the array if needed */
-static void add_point_to_path(Path *path, float x, float y) {
-    if (path->num_points >= path->capacity) {
-        path->capacity *= 2;
-        Point *new_points = realloc(path->points, path->capacity * sizeof(Point));
-        if (!new_points) {
-            return;
-        }
-        path->points = new_points;
+/* Scale a decimal mantissa by 10^exponent */
+static double scale_decimal(double value, int exponent) {
+    while (exponent > 22) {
+        value *= 1e22;
+        exponent -= 22;
     }
-    path->points[path->num_points].x = x;
-    path->points[path->num_points].y = y;
-    path->num_points++;
+    while (exponent < -22) {
+        value /= 1e22;
+        exponent += 22;
+    }
+    return exponent >= 0 ? value * powers_of_ten[exponent] : value / powers_of_ten[-exponent];
 }
 
-/* Add all paths from a compound path to the SVG structure
- * First path is considered the outer path, subsequent paths are holes
+/* Scan a decimal number: [sign] digits [. digits] [e [sign] digits]
+ * Digits accumulate in an integer that is scaled once by a power of ten.
+ * Typical path numbers (up to 7 digits, up to 10 decimals) take a single
+ * correctly rounded float operation on exact operands; longer ones go
+ * through double precision. Never reads past the end of the data.
+ * Returns: Position after the number, or NULL if no number starts at p
  */
-static void add_compound_path_to_svg(SVGPath *svg, CompoundPath *compound) {
-    for (int i = 0; i < compound->num_paths; i++) {
-        if (svg->num_paths >= svg->capacity) {
-            svg->capacity *= 2;
-            Path *new_paths = realloc(svg->paths, svg->capacity * sizeof(Path));
-            if (!new_paths) {
-                return;
+static inline const char *scan_decimal(const char *p, const char *end, float *value) {
+    bool negative = false;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = (*p == '-');
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+
+    for (; p < end && is_digit(*p); p++, any = true) {
+        if (digits < MAX_MANTISSA_DIGITS) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa) digits++;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && is_digit(*p); p++, any = true) {
+            if (digits < MAX_MANTISSA_DIGITS) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa) digits++;
+                exponent--;
             }
-            svg->paths = new_paths;
         }
-        svg->paths[svg->num_paths] = compound->paths[i];
-        svg->paths[svg->num_paths].is_hole = (i > 0); // First path is outer, rest are holes
-        svg->num_paths++;
     }
+    if (!any) return NULL;
+
+    // The exponent only counts when digits follow the e, so "1e" stays 1
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        bool negative_exponent = false;
+        if (q < end && (*q == '+' || *q == '-')) {
+            negative_exponent = (*q == '-');
+            q++;
+        }
+        if (q < end && is_digit(*q)) {
+            int e = 0;
+            for (; q < end && is_digit(*q); q++) {
+                if (e < 10000) e = e * 10 + (*q - '0');
+            }
+            exponent += negative_exponent ? -e : e;
+            p = q;
+        }
+    }
+
+    float result;
+    if (mantissa <= MAX_EXACT_FLOAT_MANTISSA && exponent <= 0 && exponent >= -10) {
+        result = (float)mantissa / float_powers_of_ten[-exponent];
+    } else {
+        result = mantissa ? (float)scale_decimal((double)mantissa, exponent) : 0.0f;
+    }
+    *value = negative ? -result : result;
+    return p;
+}
+
+/* Scan a number of an attribute value outside path data */
+const char *scan_svg_number(const char *p, const char *end, float *value) {
+    return scan_decimal(p, end, value);
+}
+
+/* Scan the next number of the path data after any separators
+ * Returns: false if no number starts there (the position is left unchanged)
+ */
+static bool scan_number(PathParser *ps, float *value) {
+    skip_separators(ps);
+
+    const char *p = scan_decimal(ps->p, ps->end, value);
+    if (!p) return false;
+    ps->p = p;
+    return true;
+}
+
+/* Scan a coordinate pair, relative to the current point if requested */
+static bool scan_point(PathParser *ps, bool relative, Point *point) {
+    if (!scan_number(ps, &point->x) || !scan_number(ps, &point->y)) return false;
+    if (relative) {
+        point->x += ps->current.x;
+        point->y += ps->current.y;
+    }
+    return true;
+}
+
+/* Scan an arc flag, a single 0 or 1 that needs no separator after it */
+static bool scan_flag(PathParser *ps, bool *flag) {
+    skip_separators(ps);
+    if (ps->p >= ps->end || (*ps->p != '0' && *ps->p != '1')) return false;
+    *flag = (*ps->p++ == '1');
+    return true;
+}
+
+/* Append a verb and its points to an outline, growing the arrays if needed
+ * Returns: false if memory ran out (the outline is left unchanged)
+ */
+static bool add_verb(SVGOutline *outline, PathVerb verb, const Point *points, uint32_t count) {
+    if (outline->num_verbs >= outline->verb_capacity) {
+        uint32_t capacity = outline->verb_capacity * 2;
+        uint8_t *verbs = realloc(outline->verbs, capacity);
+        if (!verbs) {
+            return false;
+        }
+        outline->verbs = verbs;
+        outline->verb_capacity = capacity;
+    }
+    if (outline->num_points + count > outline->point_capacity) {
+        uint32_t capacity = outline->point_capacity * 2 + count;
+        Point *new_points = realloc(outline->points, capacity * sizeof(Point));
+        if (!new_points) {
+            return false;
+        }
+        outline->points = new_points;
+        outline->point_capacity = capacity;
+    }
+
+    outline->verbs[outline->num_verbs++] = (uint8_t)verb;
+    memcpy(&outline->points[outline->num_points], points, count * sizeof(Point));
+    outline->num_points += count;
+    return true;
 }
 
 /* Parse an RGB color string into a Color structure */
 Color parse_color(const char *color_str) {
     Color color = {0, 0, 0, 255}; // Default to opaque black
-    
-    if (strstr(color_str, "rgb(") == color_str) {
-        int r, g, b;
-        if (sscanf(color_str, "rgb(%d,%d,%d)", &r, &g, &b) == 3) {
-            color.r = (uint8_t)r;
-            color.g = (uint8_t)g;
-            color.b = (uint8_t)b;
+
+    if (strncmp(color_str, "rgb(", 4) == 0) {
+        PathParser ps = {0};
+        ps.p = color_str + 4;
+        ps.end = color_str + strlen(color_str);
+        float rgb[3];
+        for (int i = 0; i < 3; i++) {
+            if (!scan_number(&ps, &rgb[i])) return color;
+        }
+        skip_separators(&ps);
+        if (ps.p < ps.end && *ps.p == ')') {
+            color.r = (uint8_t)rgb[0];
+            color.g = (uint8_t)rgb[1];
+            color.b = (uint8_t)rgb[2];
         }
     }
 
     return color;
 }
 
-/* Parse an SVG path data string into an SVGPath structure
- * Handles multiple subpaths and holes
- * Supports commands: M, L, H, V, C, Z
+/* Start a sub-path at the current point if drawing follows Z without M */
+static bool ensure_open(PathParser *ps) {
+    if (ps->open) return true;
+    ps->open = true;
+    ps->start = ps->current;
+    return add_verb(ps->outline, PATH_MOVE, &ps->current, 1);
+}
+
+/* Straight line from the current point */
+static bool line_to(PathParser *ps, Point point) {
+    if (!ensure_open(ps)) return false;
+    ps->current = point;
+    return add_verb(ps->outline, PATH_LINE, &point, 1);
+}
+
+/* Cubic Bezier from the current point */
+static bool cubic_to(PathParser *ps, Point c1, Point c2, Point point) {
+    if (!ensure_open(ps)) return false;
+    Point pts[3] = { c1, c2, point };
+    ps->current = point;
+    return add_verb(ps->outline, PATH_CUBIC, pts, 3);
+}
+
+/* Quadratic Bezier, stored as the cubic that traces the same curve */
+static bool quadratic_to(PathParser *ps, Point control, Point point) {
+    Point c1 = { ps->current.x + 2.0f / 3.0f * (control.x - ps->current.x),
+                 ps->current.y + 2.0f / 3.0f * (control.y - ps->current.y) };
+    Point c2 = { point.x + 2.0f / 3.0f * (control.x - point.x),
+                 point.y + 2.0f / 3.0f * (control.y - point.y) };
+    return cubic_to(ps, c1, c2, point);
+}
+
+/* Signed angle from vector (ux, uy) to (vx, vy) */
+static double vector_angle(double ux, double uy, double vx, double vy) {
+    return atan2(ux * vy - uy * vx, ux * vx + uy * vy);
+}
+
+/* Elliptical arc, converted to cubics of at most 90 degrees each
+ * Follows the endpoint-to-center conversion of SVG 1.1 appendix F.6, with
+ * radii scaled up when they are too small to reach the end point.
  */
-SVGPath* parse_svg_path(const char *path_data, const char *style) {
-    // Initialize SVG structure
-    SVGPath *svg = malloc(sizeof(SVGPath));
-    if (!svg) return NULL;
-
-    svg->paths = malloc(INITIAL_CAPACITY * sizeof(Path));
-    if (!svg->paths) {
-        free(svg);
-        return NULL;
+static bool arc_to(PathParser *ps, float rx_in, float ry_in, float rotation,
+                   bool large_arc, bool sweep, Point point) {
+    Point from = ps->current;
+    if (from.x == point.x && from.y == point.y) return true;
+
+    double rx = fabs(rx_in);
+    double ry = fabs(ry_in);
+    if (rx == 0.0 || ry == 0.0) return line_to(ps, point);
+
+    double phi = rotation * M_PI / 180.0;
+    double cos_phi = cos(phi);
+    double sin_phi = sin(phi);
+
+    // Midpoint in the ellipse's own axes
+    double dx = (from.x - point.x) / 2.0;
+    double dy = (from.y - point.y) / 2.0;
+    double x1 = cos_phi * dx + sin_phi * dy;
+    double y1 = -sin_phi * dx + cos_phi * dy;
+
+    double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+    if (lambda > 1.0) {
+        rx *= sqrt(lambda);
+        ry *= sqrt(lambda);
     }
 
-    svg->num_paths = 0;
-    svg->capacity = INITIAL_CAPACITY;
-    svg->fill_color = parse_color(style);
+    double numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    double denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+    double coef = sqrt(fmax(0.0, numerator / denominator));
+    if (large_arc == sweep) coef = -coef;
+    double cx1 = coef * rx * y1 / ry;
+    double cy1 = -coef * ry * x1 / rx;
+
+    double cx = cos_phi * cx1 - sin_phi * cy1 + (from.x + point.x) / 2.0;
+    double cy = sin_phi * cx1 + cos_phi * cy1 + (from.y + point.y) / 2.0;
+
+    double theta = vector_angle(1.0, 0.0, (x1 - cx1) / rx, (y1 - cy1) / ry);
+    double delta = vector_angle((x1 - cx1) / rx, (y1 - cy1) / ry,
+                                (-x1 - cx1) / rx, (-y1 - cy1) / ry);
+    if (!sweep && delta > 0) delta -= 2.0 * M_PI;
+    if (sweep && delta < 0) delta += 2.0 * M_PI;
+
+    int segments = (int)ceil(fabs(delta) / (M_PI / 2.0) - 1e-9);
+    if (segments < 1) segments = 1;
+    double step = delta / segments;
+    double k = 4.0 / 3.0 * tan(step / 4.0);
+
+    for (int i = 0; i < segments; i++) {
+        double a0 = theta + i * step;
+        double a1 = a0 + step;
+        double cos0 = cos(a0), sin0 = sin(a0);
+        double cos1 = cos(a1), sin1 = sin(a1);
+
+        // Control points on the unit circle, then onto the rotated ellipse
+        double ux[3] = { cos0 - k * sin0, cos1 + k * sin1, cos1 };
+        double uy[3] = { sin0 + k * cos0, sin1 - k * cos1, sin1 };
+        Point pts[3];
+        for (int j = 0; j < 3; j++) {
+            pts[j].x = (float)(cx + rx * ux[j] * cos_phi - ry * uy[j] * sin_phi);
+            pts[j].y = (float)(cy + rx * ux[j] * sin_phi + ry * uy[j] * cos_phi);
+        }
+        if (i == segments - 1) pts[2] = point;
+        if (!cubic_to(ps, pts[0], pts[1], pts[2])) return false;
+    }
+    return true;
+}
 
-    // Initialize compound path structure
-    CompoundPath compound = {0};
-    compound.num_paths = 0;
+/* Whether c is a path command letter */
+static bool is_command(char c) {
+    switch (c) {
+        case 'M': case 'm': case 'L': case 'l': case 'H': case 'h':
+        case 'V': case 'v': case 'C': case 'c': case 'S': case 's':
+        case 'Q': case 'q': case 'T': case 't': case 'A': case 'a':
+        case 'Z': case 'z':
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Parse the arguments of one command and emit its verbs
+ * Returns: 1 on success, 0 on malformed arguments, -1 if memory ran out
+ */
+static int parse_command(PathParser *ps, char command) {
+    bool relative = (command >= 'a');
+    char upper = relative ? (char)(command - 'a' + 'A') : command;
+    Point p1, p2, p3;
+    float value;
+    bool ok = true;
+
+    switch (upper) {
+        case 'M': // Move To
+            if (!scan_point(ps, relative, &p1)) return 0;
+            ps->current = ps->start = p1;
+            ps->open = true;
+            ok = add_verb(ps->outline, PATH_MOVE, &p1, 1);
+            break;
+
+        case 'L': // Line To
+            if (!scan_point(ps, relative, &p1)) return 0;
+            ok = line_to(ps, p1);
+            break;
+
+        case 'H': // Horizontal Line
+            if (!scan_number(ps, &value)) return 0;
+            p1.x = relative ? ps->current.x + value : value;
+            p1.y = ps->current.y;
+            ok = line_to(ps, p1);
+            break;
+
+        case 'V': // Vertical Line
+            if (!scan_number(ps, &value)) return 0;
+            p1.x = ps->current.x;
+            p1.y = relative ? ps->current.y + value : value;
+            ok = line_to(ps, p1);
+            break;
+
+        case 'C': // Cubic Bezier Curve
+            if (!scan_point(ps, relative, &p1) || !scan_point(ps, relative, &p2) ||
+                !scan_point(ps, relative, &p3)) return 0;
+            ok = cubic_to(ps, p1, p2, p3);
+            ps->control = p2;
+            break;
+
+        case 'S': // Smooth Cubic: first control point mirrors the previous one
+            if (!scan_point(ps, relative, &p2) || !scan_point(ps, relative, &p3)) return 0;
+            p1 = ps->current;
+            if (ps->previous == 'C' || ps->previous == 'S') {
+                p1.x = 2 * ps->current.x - ps->control.x;
+                p1.y = 2 * ps->current.y - ps->control.y;
+            }
+            ok = cubic_to(ps, p1, p2, p3);
+            ps->control = p2;
+            break;
+
+        case 'Q': // Quadratic Bezier Curve
+            if (!scan_point(ps, relative, &p1) || !scan_point(ps, relative, &p2)) return 0;
+            ok = quadratic_to(ps, p1, p2);
+            ps->control = p1;
+            break;
+
+        case 'T': // Smooth Quadratic: control point mirrors the previous one
+            if (!scan_point(ps, relative, &p2)) return 0;
+            p1 = ps->current;
+            if (ps->previous == 'Q' || ps->previous == 'T') {
+                p1.x = 2 * ps->current.x - ps->control.x;
+                p1.y = 2 * ps->current.y - ps->control.y;
+            }
+            ok = quadratic_to(ps, p1, p2);
+            ps->control = p1;
+            break;
+
+        case 'A': { // Elliptical Arc
+            float rx, ry, rotation;
+            bool large_arc, sweep;
+            if (!scan_number(ps, &rx) || !scan_number(ps, &ry) || !scan_number(ps, &rotation) ||
+                !scan_flag(ps, &large_arc) || !scan_flag(ps, &sweep) ||
+                !scan_point(ps, relative, &p1)) return 0;
+            ok = arc_to(ps, rx, ry, rotation, large_arc, sweep, p1);
+            break;
+        }
+
+        case 'Z': // Close Path
+            if (ps->open) {
+                ok = add_verb(ps->outline, PATH_CLOSE, &ps->start, 0);
+                ps->open = false;
+            }
+            ps->current = ps->start;
+            break;
+    }
 
-    // Initialize first path
-    Path *current_path = &compound.paths[0];
-    current_path->points = malloc(INITIAL_CAPACITY * sizeof(Point));
-    if (!current_path->points) {
-        free(svg->paths);
-        free(svg);
+    ps->previous = upper;
+    return ok ? 1 : -1;
+}
+
+/* Parse SVG path data into an SVGOutline structure
+ * Curves are recorded with their control points, not flattened
+ * Supports every command of the SVG path grammar, absolute and relative:
+ * M, L, H, V, C, S, Q, T, A and Z. Quadratics become the equivalent cubics
+ * and arcs become cubics of at most 90 degrees each.
+ */
+SVGOutline* parse_svg_outline_data(const char *path_data, size_t length, Color fill_color) {
+    // Initialize outline structure
+    SVGOutline *outline = calloc(1, sizeof(SVGOutline));
+    if (!outline) return NULL;
+
+    outline->verbs = malloc(INITIAL_CAPACITY);
+    outline->points = malloc(INITIAL_CAPACITY * sizeof(Point));
+    if (!outline->verbs || !outline->points) {
+        free_svg_outline(outline);
         return NULL;
     }
-    current_path->num_points = 0;
-    current_path->capacity = INITIAL_CAPACITY;
-    current_path->is_hole = 0;
+    outline->verb_capacity = INITIAL_CAPACITY;
+    outline->point_capacity = INITIAL_CAPACITY;
+    outline->fill_color = fill_color;
 
-    const char *p = path_data;
-    char command = 'M';
-    float x1, y1, x2, y2, x3, y3;
-    bool new_subpath = true;
+    PathParser ps = { path_data, path_data + length, {0, 0}, {0, 0}, {0, 0}, 0, false, outline };
+    char command = 0;
 
     // Parse path commands
-    while (*p) {
-        if (isalpha(*p)) {
-            // Handle new subpath creation
-            if (*p == 'M' && !new_subpath) {
-                if (current_path->num_points > 0) {
-                    compound.num_paths++;
-                    if (compound.num_paths < MAX_SUBPATHS) {
-                        current_path = &compound.paths[compound.num_paths];
-                        current_path->points = malloc(INITIAL_CAPACITY * sizeof(Point));
-                        current_path->num_points = 0;
-                        current_path->capacity = INITIAL_CAPACITY;
-                        current_path->is_hole = 1;
-                    }
-                }
-            }
-            command = *p++;
-            new_subpath = (command == 'M');
+    for (;;) {
+        skip_separators(&ps);
+        if (ps.p >= ps.end) break;
+
+        if (is_command(*ps.p)) {
+            command = *ps.p++;
+        } else if (command == 0 || command == 'Z' || command == 'z') {
+            // Numbers need a command to repeat, and data must begin with M
+            break;
         }
+        if (ps.previous == 0 && command != 'M' && command != 'm') break;
 
-        // Process commands
-        switch (command) {
-            case 'M': // Move To
-                x1 = parse_number(&p);
-                y1 = parse_number(&p);
-                add_point_to_path(current_path, x1, y1);
-                current_point.x = start_point.x = x1;
-                current_point.y = start_point.y = y1;
-                command = 'L'; // After M, implicit command is L
-                break;
-
-            case 'L': // Line To
-                x1 = parse_number(&p);
-                y1 = parse_number(&p);
-                add_point_to_path(current_path, x1, y1);
-                current_point.x = x1;
-                current_point.y = y1;
-                break;
-
-            case 'H': // Horizontal Line
-                x1 = parse_number(&p);
-                add_point_to_path(current_path, x1, current_point.y);
-                current_point.x = x1;
-                break;
-
-            case 'V': // Vertical Line
-                y1 = parse_number(&p);
-                add_point_to_path(current_path, current_point.x, y1);
-                current_point.y = y1;
-                break;
-
-            case 'Z': // Close Path
-            case 'z':
-                if (current_path->num_points > 0) {
-                    add_point_to_path(current_path, start_point.x, start_point.y);
-                }
-                break;
-
-            case 'C': // Cubic Bezier Curve
-                // Get control points and end point
-                x1 = parse_number(&p);
-                y1 = parse_number(&p);
-                x2 = parse_number(&p);
-                y2 = parse_number(&p);
-                x3 = parse_number(&p);
-                y3 = parse_number(&p);
-
-                // Approximate curve with line segments
-                for (float t = 0; t <= 1; t += 0.1) {
-                    float t_squared = t * t;
-                    float t_cubed = t_squared * t;
-                    float mt = 1 - t;
-                    float mt_squared = mt * mt;
-                    float mt_cubed = mt_squared * mt;
-
-                    // Cubic Bezier formula
-                    float px = current_point.x * mt_cubed +
-                              3 * x1 * mt_squared * t +
-                              3 * x2 * mt * t_squared +
-                              x3 * t_cubed;
-
-                    float py = current_point.y * mt_cubed +
-                              3 * y1 * mt_squared * t +
-                              3 * y2 * mt * t_squared +
-                              y3 * t_cubed;
-
-                    add_point_to_path(current_path, px, py);
-                }
-
-                current_point.x = x3;
-                current_point.y = y3;
-                break;
-
-            default:
-                // Skip unknown commands
-                while (*p && !isalpha(*p)) p++;
-                break;
+        int status = parse_command(&ps, command);
+        if (status < 0) {
+            free_svg_outline(outline);
+            return NULL;
         }
+        if (status == 0) break;
 
-        // Skip whitespace
-        while (isspace(*p)) p++;
+        // Coordinates after a move are implicit line commands
+        if (command == 'M') command = 'L';
+        else if (command == 'm') command = 'l';
     }
 
-    // Add final path if it contains points
-    if (current_path->num_points > 0) {
-        compound.num_paths++;
-    }
+    return outline;
+}
+
+/* Parse an SVG path data string into an SVGOutline structure */
+SVGOutline* parse_svg_outline(const char *path_data, const char *style) {
+    return parse_svg_outline_data(path_data, strlen(path_data), parse_color(style));
+}
 
-    // Add all paths to SVG structure
-    add_compound_path_to_svg(svg, &compound);
+/* Parse an SVG path data string into a flattened SVGPath structure */
+SVGPath* parse_svg_path(const char *path_data, const char *style, Arena *arena) {
+    SVGOutline *outline = parse_svg_outline(path_data, style);
+    if (!outline) return NULL;
 
+    SVGPath *svg = flatten_svg_outline(outline, DEFAULT_FLATTEN_TOLERANCE, arena);
+    free_svg_outline(outline);
     return svg;
 }
 
-/* Free all resources associated with an SVG path */
-void free_svg_path(SVGPath *svg) {
-    if (svg) {
-        for (uint32_t i = 0; i < svg->num_paths; i++) {
-            free(svg->paths[i].points);
-        }
-        free(svg->paths);
-        free(svg);
+/* Free all resources associated with an SVG outline */
+void free_svg_outline(SVGOutline *outline) {
+    if (outline) {
+        free(outline->verbs);
+        free(outline->points);
+        free(outline);
     }
 }
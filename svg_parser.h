@@ -1,17 +1,47 @@
 #ifndef SVG_PARSER_H
 #define SVG_PARSER_H
 
+#include <stddef.h>
 #include "svg_types.h"
+#include "arena.h"
 
-/* Parse an SVG path string into an SVGPath structure
+/* Parse an SVG path string into an SVGOutline structure without flattening
  * path_data: SVG path data string (e.g., "M 0,0 L 100,100 Z")
  * style: CSS style string containing color information
- * Returns: Pointer to parsed SVGPath structure or NULL on failure
+ * Returns: Pointer to parsed SVGOutline structure or NULL on failure
+ */
+SVGOutline* parse_svg_outline(const char *path_data, const char *style);
+
+/* Parse length bytes of SVG path data into an SVGOutline structure
+ * path_data need not be NUL-terminated and nothing past length is read, so
+ * attribute values can be parsed in place. All state is local to the call.
+ * Parsing stops quietly at the first malformed command, keeping what came
+ * before it.
+ * fill_color: Fill color of the outline
+ * Returns: Pointer to parsed SVGOutline structure or NULL on failure
+ */
+SVGOutline* parse_svg_outline_data(const char *path_data, size_t length, Color fill_color);
+
+/* Scan a decimal number, [sign] digits [. digits] [e [sign] digits],
+ * starting at p
+ * Nothing at or past end is read and the C locale is never consulted, so
+ * numbers in attribute values parse the same under any LC_NUMERIC.
+ * Returns: Position after the number, or NULL if no number starts at p
  */
-SVGPath* parse_svg_path(const char *path_data, const char *style);
+const char *scan_svg_number(const char *p, const char *end, float *value);
 
-/* Free resources associated with an SVGPath structure */
-void free_svg_path(SVGPath *path);
+/* Free resources associated with an SVGOutline structure */
+void free_svg_outline(SVGOutline *outline);
+
+/* Parse an SVG path string into a flattened SVGPath structure
+ * Curves are flattened with DEFAULT_FLATTEN_TOLERANCE in path units; use
+ * parse_svg_outline and flatten_svg_outline when the output scale is known
+ * path_data: SVG path data string (e.g., "M 0,0 L 100,100 Z")
+ * style: CSS style string containing color information
+ * arena: Arena owning the result; it is freed with the arena
+ * Returns: Pointer to parsed SVGPath structure or NULL on failure
+ */
+SVGPath* parse_svg_path(const char *path_data, const char *style, Arena *arena);
 
 /* Parse a color string into a Color structure
  * Supports RGB format (e.g., "rgb(255,0,0)")
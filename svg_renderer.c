@@ -1,256 +1,1727 @@
 #include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include <math.h>
 #include "svg_renderer.h"
+#include "coverage.h"
+#include "span_fill.h"
+#include "thread_pool.h"
+#include "transform.h"
+#include "fixed_point.h"
 
-#define MAX_INTERSECTIONS 1000
+/* Rows a scene is composited in at a time on the strip path; AA lines are
+ * binned per strip
+ */
+#define SCENE_STRIP_ROWS 16
+
+/* Edge length of the square tiles a scene is binned and composited in;
+ * a tile of colors plus one of coverage stays within a 32 KiB L1 cache
+ */
+#define SCENE_TILE_SIZE 64
+
+/* In-out state of a row of an aliased layer, per the even-odd rule */
+#define STATE_INSIDE 1  // Inside an odd number of sub-paths
 
-/* Original SVG dimensions used for scaling calculations */
-static const float BASE_SVG_WIDTH = 1284.0f;
-static const float BASE_SVG_HEIGHT = 1284.0f;
+/* Screen-space polygon edge for the active edge table
+ * Built once per path and shared read-only by every render thread
+ */
+typedef struct
+{
+    PathCoord x;     // X-coordinate at scanline y_start
+    PathCoord dxdy;  // X increment per scanline
+    int y_start;     // First scanline crossed by the edge
+    int y_end;       // One past the last scanline crossed by the edge
+} Edge;
 
-/* Structure to track path intersections with scanlines */
+/* Entry in a band's private active edge list */
 typedef struct
 {
-    int x;             // X-coordinate of intersection
-    bool is_hole_edge; // Whether this intersection is from a hole
-} Intersection;
+    PathCoord x;       // X-coordinate at the current scanline
+    const Edge *edge;  // Shared edge this entry tracks
+} ActiveEdge;
 
-/* Pre-calculated cosine values for common rotation angles */
-static const float rotation_cos[] = {
-    1.0f,  // 0 degrees
-    0.0f,  // 90 degrees
-    -1.0f, // 180 degrees
-    0.0f   // 270 degrees
-};
+/* Band-private scan state over the sorted edges of one path */
+typedef struct
+{
+    const Edge *edges;    // Sorted by start row
+    int num_edges;
+    int next_edge;        // First edge not yet activated
+    int num_active;
+    ActiveEdge *active;   // Active edges, sorted by x on the last row scanned
+    int *spans;           // Filled spans of the last row scanned, start and end pairs
+} EdgeScan;
+
+/* Screen-space line of one path */
+typedef struct
+{
+    float x0, y0;
+    float x1, y1;
+    float winding;  // Signed contribution, see build_coverage_lines()
+} CoverageLine;
 
-/* Pre-calculated sine values for common rotation angles */
-static const float rotation_sin[] = {
-    0.0f, // 0 degrees
-    1.0f, // 90 degrees
-    0.0f, // 180 degrees
-    -1.0f // 270 degrees
+/* One path of a scene, in screen space
+ * Aliased layers keep the sorted edge table. On the strip path,
+ * anti-aliased layers keep their lines with an index of the lines crossing
+ * each strip of rows. On the tile path, layers are binned into the screen's
+ * tiles: aliased layers list the edges crossing each tile, anti-aliased
+ * layers are cut at tile boundaries into pieces that each lie in a single
+ * tile. The tile box bounds what the layer can cover; tiles outside it are
+ * not indexed at all.
+ */
+typedef struct
+{
+    uint32_t color;
+    Edge *edges;            // Aliased: sorted by start row
+    int num_edges;
+    int y_start;            // Strips: first row the layer may touch
+    int y_end;              // Strips: one past the last row
+    CoverageLine *lines;    // Strips, anti-aliased: lines of every sub-path
+    uint32_t *strip_first;  // Per strip, first entry of strip_lines; one extra at the end
+    uint32_t *strip_lines;  // Line indices grouped by strip
+    int box_x0;             // Screen column of coverage column 0
+    int box_width;          // Coverage columns
+    int tile_x0, tile_y0;   // Tiles: tile box, first tile column and row
+    int tile_x1, tile_y1;   // One past the last
+    uint32_t *tile_first;   // Per tile of the box, first entry; one extra at the end
+    uint32_t *tile_edges;   // Aliased: edge indices grouped by tile
+    CoverageLine *pieces;   // Anti-aliased: line pieces grouped by tile
+} SceneLayer;
+
+struct RenderScene
+{
+    Transform transform;
+    RenderMode mode;
+    SceneCompositor compositor;
+    uint32_t background;
+    int width;              // Screen size the layers were built for
+    int height;
+    uint32_t max_entries;   // Most entries of any layer in one tile
+    SceneLayer *layers;     // In painter's order
+    int num_layers;
+    int capacity;
 };
 
-/* Comparison function for sorting intersections by x-coordinate */
-static int compare_intersections(const void *a, const void *b)
+/* Scene and target shared by the bands compositing it */
+typedef struct
+{
+    Framebuffer *fb;
+    const RenderScene *scene;
+    int width;              // Columns written, clipped to the framebuffer
+    int height;             // Rows written
+    bool failed;            // Set by a band that could not draw all its rows
+} SceneJob;
+
+/* Solid rectangle cleared band by band */
+typedef struct
+{
+    Framebuffer *fb;
+    uint32_t color;
+} ClearJob;
+
+/* Pool shared by every render call, NULL to render on the calling thread */
+static ThreadPool *render_pool;
+
+/* Calculate the uniform scale that fits the SVG into its display area */
+float get_svg_scale(const DisplayInfo *display_info)
+{
+    float scale_x = (float)display_info->svg_width / display_info->view_box.width;
+    float scale_y = (float)display_info->svg_height / display_info->view_box.height;
+    return (scale_x < scale_y) ? scale_x : scale_y;
+}
+
+/* Compose the transform from SVG units to screen pixels
+ * The logo is scaled, centered on its display area and rotated about the
+ * center of that area in one matrix.
+ */
+void get_display_transform(const DisplayInfo *display_info, Transform *transform)
+{
+    float scale = get_svg_scale(display_info);
+    float center_x = display_info->x_offset + display_info->svg_width / 2.0f;
+    float center_y = display_info->y_offset + display_info->svg_height / 2.0f;
+
+    const ViewBox *view_box = &display_info->view_box;
+    Transform to_origin = transform_translate(-(view_box->x + view_box->width / 2.0f),
+                                              -(view_box->y + view_box->height / 2.0f));
+    Transform scaled = transform_scale(scale, scale);
+    Transform rotated = transform_rotate(display_info->rotation);
+    Transform to_center = transform_translate(center_x, center_y);
+
+    Transform t = transform_multiply(&scaled, &to_origin);
+    t = transform_multiply(&rotated, &t);
+    *transform = transform_multiply(&to_center, &t);
+}
+
+/* Fill color of a path as a 32-bit color value */
+static uint32_t path_color(const SVGPath *svg)
 {
-    return ((Intersection *)a)->x - ((Intersection *)b)->x;
+    return (svg->fill_color.r << 16) | (svg->fill_color.g << 8) | svg->fill_color.b;
 }
 
-/* Calculate bounding box of SVG path */
-static void calculate_svg_bounds(SVGPath *svg, float *min_x, float *max_x, float *min_y, float *max_y)
+/* Build the screen-space edge table for an SVG path
+ * Every point is transformed exactly once, into the clamped range of
+ * transform_path_point(); horizontal and off-screen edges are dropped, the
+ * rest are clipped to the screen rows and counting-sorted by their first
+ * scanline.
+ * Returns: malloc'd edge array (caller frees) or NULL if empty or out of memory
+ */
+static Edge *build_edge_table(const SVGPath *svg, const Transform *transform, int rows,
+                              int *count)
 {
-    *min_x = *min_y = 1e6f;
-    *max_x = *max_y = -1e6f;
+    uint32_t total = svg->num_points;
+
+    *count = 0;
+    if (total == 0 || rows <= 0)
+        return NULL;
+
+    Edge *edges = malloc(total * sizeof(Edge));
+    Edge *sorted = malloc(total * sizeof(Edge));
+    uint32_t *bucket = calloc(rows + 1, sizeof(uint32_t));
+    if (!edges || !sorted || !bucket)
+    {
+        free(edges);
+        free(sorted);
+        free(bucket);
+        return NULL;
+    }
 
+    PathTransform path_transform = transform_for_paths(transform);
+    int num_edges = 0;
     for (uint32_t i = 0; i < svg->num_paths; i++)
     {
-        Path *path = &svg->paths[i];
+        const Path *path = &svg->paths[i];
+        const PathPoint *points = path_points(svg, path);
+        if (path->num_points == 0)
+            continue;
+
+        // The last point wraps around to the first, closing the sub-path
+        PathPoint prev = transform_path_point(&path_transform, points[path->num_points - 1]);
+        PathCoord prev_x = prev.x;
+        PathCoord prev_y = prev.y;
+
         for (uint32_t j = 0; j < path->num_points; j++)
         {
-            if (path->points[j].x < *min_x)
-                *min_x = path->points[j].x;
-            if (path->points[j].x > *max_x)
-                *max_x = path->points[j].x;
-            if (path->points[j].y < *min_y)
-                *min_y = path->points[j].y;
-            if (path->points[j].y > *max_y)
-                *max_y = path->points[j].y;
+            PathPoint p = transform_path_point(&path_transform, points[j]);
+            PathCoord x = p.x;
+            PathCoord y = p.y;
+
+            PathCoord x_top = prev_x, y_top = prev_y, y_bottom = y;
+            if (prev_y > y)
+            {
+                x_top = x;
+                y_top = y;
+                y_bottom = prev_y;
+            }
+            PathCoord dxdy = y != prev_y ? coord_div(x - prev_x, y - prev_y) : 0;
+            prev_x = x;
+            prev_y = y;
+
+            // Scanline y is crossed when y_top <= y < y_bottom
+            int y_start = coord_ceil(y_top);
+            int y_end = coord_ceil(y_bottom);
+            if (y_start >= y_end || y_end <= 0 || y_start >= rows)
+                continue;
+
+            // Edges entering above the screen start on row 0
+            y_start = y_start > 0 ? y_start : 0;
+            y_end = y_end < rows ? y_end : rows;
+
+            Edge *e = &edges[num_edges++];
+            e->x = x_top + coord_mul(coord_from_int(y_start) - y_top, dxdy);
+            e->dxdy = dxdy;
+            e->y_start = y_start;
+            e->y_end = y_end;
+            bucket[y_start + 1]++;
         }
     }
+
+    // Counting sort by start row
+    for (int y = 0; y < rows; y++)
+        bucket[y + 1] += bucket[y];
+    for (int i = 0; i < num_edges; i++)
+        sorted[bucket[edges[i].y_start]++] = edges[i];
+
+    free(bucket);
+    free(edges);
+
+    if (num_edges == 0)
+    {
+        free(sorted);
+        return NULL;
+    }
+    *count = num_edges;
+    return sorted;
+}
+
+/* Use pool for all following render calls, or NULL for single-threaded */
+void set_render_thread_pool(ThreadPool *pool)
+{
+    render_pool = pool;
 }
 
-/* Rotate an SVG path by a specified angle
- * Uses pre-calculated sine and cosine values for efficiency
+/* Split rows y_start to y_end - 1 into bands across the render pool
+ * Span hooks (the span cache recorder) are not thread-safe, so rendering
+ * stays on the calling thread while one is attached.
  */
-void rotate_svg_path(SVGPath *svg, int angle)
+static void run_bands(Framebuffer *fb, int y_start, int y_end, BandFunc fn, void *ctx)
 {
-    // Calculate center of rotation based on original SVG dimensions
-    float center_x = BASE_SVG_WIDTH / 2.0f;
-    float center_y = BASE_SVG_HEIGHT / 2.0f;
+    thread_pool_run_bands(fb->span_hook ? NULL : render_pool, y_start, y_end, fn, ctx);
+}
 
-    int angle_index = (angle / 90) % 4;
-    float cos_angle = rotation_cos[angle_index];
-    float sin_angle = rotation_sin[angle_index];
+/* X-coordinate of an edge on scanline y, evaluated from its start row */
+static inline PathCoord edge_x(const Edge *e, int y)
+{
+    return coord_step(e->x, y - e->y_start, e->dxdy);
+}
 
-    // Rotate each point in each path
-    for (uint32_t i = 0; i < svg->num_paths; i++)
+/* Start scanning edges at row y; edges that started above it are active
+ * Returns: 0 on success, -1 on allocation failure
+ */
+static int edge_scan_init(EdgeScan *scan, const Edge *edges, int num_edges, int y)
+{
+    scan->edges = edges;
+    scan->num_edges = num_edges;
+    scan->next_edge = 0;
+    scan->num_active = 0;
+    scan->active = malloc(num_edges * sizeof(ActiveEdge));
+    scan->spans = malloc(num_edges * 2 * sizeof(int));
+    if (!scan->active || !scan->spans)
     {
-        Path *path = &svg->paths[i];
-        for (uint32_t j = 0; j < path->num_points; j++)
+        free(scan->active);
+        free(scan->spans);
+        return -1;
+    }
+
+    while (scan->next_edge < num_edges && edges[scan->next_edge].y_start < y)
+    {
+        const Edge *e = &edges[scan->next_edge++];
+        if (e->y_end > y)
+            scan->active[scan->num_active++].edge = e;
+    }
+    return 0;
+}
+
+/* Free the lists of an edge scan */
+static void edge_scan_free(EdgeScan *scan)
+{
+    free(scan->active);
+    free(scan->spans);
+}
+
+/* First row at or after y with an active edge, INT_MAX once every edge is done
+ * Empty rows are skipped straight to the next starting edge.
+ */
+static int edge_scan_next_row(const EdgeScan *scan, int y)
+{
+    if (scan->num_active > 0)
+        return y;
+    if (scan->next_edge < scan->num_edges)
+    {
+        int y_start = scan->edges[scan->next_edge].y_start;
+        return y_start > y ? y_start : y;
+    }
+    return INT_MAX;
+}
+
+/* Find the filled spans of row y into scan->spans, then retire edges ending on it
+ * Rows must come in increasing order, skipping only rows edge_scan_next_row skips.
+ * The x of every active edge is evaluated from its start row, so the output
+ * does not depend on where a band begins.
+ * Returns: Number of spans; each is an inclusive, unclipped column range
+ */
+static int edge_scan_row(EdgeScan *scan, int y)
+{
+    const Edge *edges = scan->edges;
+    ActiveEdge *active = scan->active;
+    int num_active = scan->num_active;
+
+    // Activate edges starting on this scanline
+    while (scan->next_edge < scan->num_edges && edges[scan->next_edge].y_start == y)
+        active[num_active++].edge = &edges[scan->next_edge++];
+
+    // Insertion sort by x; the list is nearly sorted from the previous row
+    for (int i = 0; i < num_active; i++)
+    {
+        ActiveEdge e = active[i];
+        e.x = edge_x(e.edge, y);
+        int j = i - 1;
+        while (j >= 0 && active[j].x > e.x)
         {
-            // Translate to origin
-            float x = path->points[j].x - center_x;
-            float y = path->points[j].y - center_y;
+            active[j + 1] = active[j];
+            j--;
+        }
+        active[j + 1] = e;
+    }
 
-            // Rotate
-            float new_x = x * cos_angle - y * sin_angle;
-            float new_y = x * sin_angle + y * cos_angle;
+    bool inside = false;
+    int num_spans = 0;
 
-            // Translate back
-            path->points[j].x = new_x + center_x;
-            path->points[j].y = new_y + center_y;
+    // Fill between pairs of intersections, by the even-odd rule
+    for (int i = 0; i < num_active - 1; i++)
+    {
+        inside = !inside;
+        if (inside)
+        {
+            scan->spans[2 * num_spans] = coord_trunc(active[i].x);
+            scan->spans[2 * num_spans + 1] = coord_trunc(active[i + 1].x);
+            num_spans++;
         }
     }
+
+    // Retire edges that end on this scanline
+    int kept = 0;
+    for (int i = 0; i < num_active; i++)
+    {
+        if (active[i].edge->y_end > y + 1)
+            active[kept++] = active[i];
+    }
+    scan->num_active = kept;
+    return num_spans;
 }
 
-/* Render a path including holes using scanline algorithm */
-static void render_path_with_holes(Framebuffer *fb, SVGPath *svg, DisplayInfo *display_info)
+/* Twice the signed area of a closed polygon (shoelace formula) */
+static float signed_area(const PathPoint *points, uint32_t num_points)
 {
-    float min_x, max_x, min_y, max_y;
-    calculate_svg_bounds(svg, &min_x, &max_x, &min_y, &max_y);
+    float area = 0.0f;
+    for (uint32_t j = 0; j < num_points; j++)
+    {
+        const PathPoint *p = &points[j];
+        const PathPoint *q = &points[(j + 1) % num_points];
+        area += coord_to_float(p->x) * coord_to_float(q->y) -
+                coord_to_float(q->x) * coord_to_float(p->y);
+    }
+    return area;
+}
 
-    // Calculate scaling to maintain aspect ratio
-    float scale_x = (float)display_info->svg_width / BASE_SVG_WIDTH;
-    float scale_y = (float)display_info->svg_height / BASE_SVG_HEIGHT;
-    float scale = (scale_x < scale_y) ? scale_x : scale_y;
+/* Screen position of a flattened point, in float for coverage accumulation */
+static inline Point screen_point(const PathTransform *transform, PathPoint p)
+{
+    PathPoint q = transform_path_point(transform, p);
+    Point r = { coord_to_float(q.x), coord_to_float(q.y) };
+    return r;
+}
 
-    // Calculate centering offsets
-    float offset_x = display_info->x_offset;
-    float offset_y = display_info->y_offset;
+/* Screen-space lines of an SVG path for coverage accumulation
+ * Every point is transformed once, and the bounds of the path are clipped
+ * to a width x height screen on the way. Horizontal lines are dropped.
+ * Each line's winding is the signed area it adds per unit of height, so
+ * outlines add coverage and holes remove it whatever their orientation;
+ * rows prefix-summed from the accumulated area give exact coverage.
+ * box: Output, screen bounds as x0, y0, x1, y1 (exclusive)
+ * Returns: malloc'd line array (caller frees) or NULL if empty or out of memory
+ */
+static CoverageLine *build_coverage_lines(const SVGPath *svg, const Transform *transform,
+                                          int width, int height, uint32_t *count, int box[4])
+{
+    *count = 0;
+    if (svg->num_points == 0)
+        return NULL;
 
-    // Adjust offset to center the scaled SVG
-    offset_x += (display_info->svg_width - (BASE_SVG_WIDTH * scale)) / 2;
-    offset_y += (display_info->svg_height - (BASE_SVG_HEIGHT * scale)) / 2;
+    CoverageLine *lines = malloc(svg->num_points * sizeof(CoverageLine));
+    if (!lines)
+        return NULL;
 
-    // Calculate screen space bounds
-    int screen_min_y = fb->vinfo.yres;
-    int screen_max_y = 0;
+    // Mirroring reverses every outline, and with it the sign of its area
+    float orientation = transform_mirrors(transform) ? -1.0f : 1.0f;
 
-    // Find screen space bounds for all paths
+    // Transform every point once, tracking the screen-space bounds on the way
+    PathTransform path_transform = transform_for_paths(transform);
+    float min_x = INFINITY, max_x = -INFINITY;
+    float min_y = INFINITY, max_y = -INFINITY;
+    uint32_t num_lines = 0;
     for (uint32_t i = 0; i < svg->num_paths; i++)
     {
-        Path *path = &svg->paths[i];
+        const Path *path = &svg->paths[i];
+        const PathPoint *points = path_points(svg, path);
+        if (path->num_points == 0)
+            continue;
+
+        // Outer paths add coverage and holes remove it, whatever their orientation
+        float winding = signed_area(points, path->num_points) > 0 ? -orientation : orientation;
+        if (path->is_hole)
+            winding = -winding;
+
+        Point prev = screen_point(&path_transform, points[path->num_points - 1]);
+
         for (uint32_t j = 0; j < path->num_points; j++)
         {
-            int y = (int)(path->points[j].y * scale + offset_y);
-            if (y < screen_min_y)
-                screen_min_y = y;
-            if (y > screen_max_y)
-                screen_max_y = y;
+            Point p = screen_point(&path_transform, points[j]);
+            if (p.y != prev.y)
+            {
+                CoverageLine *line = &lines[num_lines++];
+                line->x0 = prev.x;
+                line->y0 = prev.y;
+                line->x1 = p.x;
+                line->y1 = p.y;
+                line->winding = winding;
+            }
+            min_x = fminf(min_x, p.x);
+            max_x = fmaxf(max_x, p.x);
+            min_y = fminf(min_y, p.y);
+            max_y = fmaxf(max_y, p.y);
+            prev = p;
         }
     }
 
-    // Clip to screen bounds
-    if (screen_min_y < 0)
-        screen_min_y = 0;
-    if (screen_max_y >= (int)fb->vinfo.yres)
-        screen_max_y = fb->vinfo.yres - 1;
+    // Screen-space bounding box, clipped to the screen
+    box[0] = min_x > 0.0f ? (int)floorf(min_x) : 0;
+    box[1] = min_y > 0.0f ? (int)floorf(min_y) : 0;
+    box[2] = max_x < width ? (int)ceilf(max_x) : width;
+    box[3] = max_y < height ? (int)ceilf(max_y) : height;
+    if (num_lines == 0 || box[0] >= box[2] || box[1] >= box[3])
+    {
+        free(lines);
+        return NULL;
+    }
+
+    *count = num_lines;
+    return lines;
+}
+
+/* Fill rows band_start to band_end - 1 of the screen */
+static void clear_band(void *arg, int band_start, int band_end)
+{
+    const ClearJob *job = arg;
+    fb_fill_rect(job->fb, 0, band_start, job->fb->vinfo.xres, band_end - band_start, job->color);
+}
+
+/* Fill the whole screen with one color, split across the render pool */
+void render_clear(Framebuffer *fb, uint32_t color)
+{
+    ClearJob job = { fb, color };
+    run_bands(fb, 0, fb->vinfo.yres, clear_band, &job);
+}
+
+/* Start an empty scene for a display layout */
+RenderScene *render_scene_create(const DisplayInfo *display_info, RenderMode mode, uint32_t background)
+{
+    RenderScene *scene = calloc(1, sizeof(RenderScene));
+    if (!scene)
+        return NULL;
+
+    get_display_transform(display_info, &scene->transform);
+    scene->mode = mode;
+    scene->background = background;
+    scene->width = display_info->screen_width;
+    scene->height = display_info->screen_height;
+    return scene;
+}
+
+/* Choose the strip or the tile path, before any path is binned for one */
+void render_scene_set_compositor(RenderScene *scene, SceneCompositor compositor)
+{
+    if (scene->num_layers == 0)
+        scene->compositor = compositor;
+}
+
+/* Record that a band left rows undrawn; bands run concurrently */
+static void scene_job_fail(SceneJob *job)
+{
+    __atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+}
+
+/* Strips of rows a line of a layer touches, clipped to the layer's rows
+ * Returns: false if the line touches none of them
+ */
+static bool line_strips(const CoverageLine *line, const SceneLayer *layer, int *first, int *last)
+{
+    float y_top = fminf(line->y0, line->y1);
+    float y_bottom = fmaxf(line->y0, line->y1);
 
-    // Allocate intersection array
-    Intersection *intersections = malloc(MAX_INTERSECTIONS * sizeof(Intersection));
-    if (!intersections)
+    int row_first = y_top > layer->y_start ? (int)floorf(y_top) : layer->y_start;
+    int row_last = y_bottom < layer->y_end ? (int)ceilf(y_bottom) - 1 : layer->y_end - 1;
+    if (row_first > row_last)
+        return false;
+
+    *first = row_first / SCENE_STRIP_ROWS;
+    *last = row_last / SCENE_STRIP_ROWS;
+    return true;
+}
+
+/* Index the lines of an anti-aliased layer by the strips of rows they cross
+ * A line crossing several strips is listed in each; the coverage buffer of
+ * a strip drops the parts outside it.
+ * Returns: 0 on success, -1 on allocation failure
+ */
+static int bin_layer_lines(SceneLayer *layer, uint32_t num_lines, int height)
+{
+    int num_strips = (height + SCENE_STRIP_ROWS - 1) / SCENE_STRIP_ROWS;
+    uint32_t *strip_first = calloc(num_strips + 1, sizeof(uint32_t));
+    if (!strip_first)
+        return -1;
+
+    // Count the lines of every strip
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < num_lines; i++)
+    {
+        int first, last;
+        if (!line_strips(&layer->lines[i], layer, &first, &last))
+            continue;
+        for (int s = first; s <= last; s++)
+            strip_first[s + 1]++;
+        total += last - first + 1;
+    }
+    for (int s = 0; s < num_strips; s++)
+        strip_first[s + 1] += strip_first[s];
+
+    uint32_t *strip_lines = malloc((total ? total : 1) * sizeof(uint32_t));
+    if (!strip_lines)
+    {
+        free(strip_first);
+        return -1;
+    }
+
+    // Place them, advancing each strip's start to the next strip's, then shift back
+    for (uint32_t i = 0; i < num_lines; i++)
+    {
+        int first, last;
+        if (!line_strips(&layer->lines[i], layer, &first, &last))
+            continue;
+        for (int s = first; s <= last; s++)
+            strip_lines[strip_first[s]++] = i;
+    }
+    for (int s = num_strips; s > 0; s--)
+        strip_first[s] = strip_first[s - 1];
+    strip_first[0] = 0;
+
+    layer->strip_first = strip_first;
+    layer->strip_lines = strip_lines;
+    return 0;
+}
+
+/* Set the tile box of a layer to the tiles holding columns x0 to x1 - 1
+ * and rows y0 to y1 - 1 of the screen
+ */
+static void layer_set_box(SceneLayer *layer, int x0, int y0, int x1, int y1)
+{
+    layer->tile_x0 = x0 / SCENE_TILE_SIZE;
+    layer->tile_y0 = y0 / SCENE_TILE_SIZE;
+    layer->tile_x1 = (x1 + SCENE_TILE_SIZE - 1) / SCENE_TILE_SIZE;
+    layer->tile_y1 = (y1 + SCENE_TILE_SIZE - 1) / SCENE_TILE_SIZE;
+}
+
+/* Number of tiles in the box of a layer */
+static int layer_num_tiles(const SceneLayer *layer)
+{
+    return (layer->tile_x1 - layer->tile_x0) * (layer->tile_y1 - layer->tile_y0);
+}
+
+/* Index of tile (tx, ty) among the tiles of a layer's box */
+static inline int layer_tile(const SceneLayer *layer, int tx, int ty)
+{
+    return (ty - layer->tile_y0) * (layer->tile_x1 - layer->tile_x0) + (tx - layer->tile_x0);
+}
+
+/* Slot for a new entry of a layer in tile (tx, ty)
+ * The counting pass grows the tile's count; the placing pass hands out the
+ * tile's slots in order.
+ */
+static uint32_t tile_slot(SceneLayer *layer, int tx, int ty, bool placing)
+{
+    uint32_t *first = &layer->tile_first[layer_tile(layer, tx, ty)];
+    if (placing)
+        return first[0]++;
+
+    first[1]++;
+    return 0;
+}
+
+/* Turn the per-tile counts of a layer into first entries
+ * Returns: Total number of entries
+ */
+static uint32_t tile_counts_to_first(SceneLayer *layer, uint32_t *max_entries)
+{
+    int num_tiles = layer_num_tiles(layer);
+    for (int t = 0; t < num_tiles; t++)
+    {
+        if (layer->tile_first[t + 1] > *max_entries)
+            *max_entries = layer->tile_first[t + 1];
+        layer->tile_first[t + 1] += layer->tile_first[t];
+    }
+    return layer->tile_first[num_tiles];
+}
+
+/* Shift the first entries back after the placing pass advanced each tile's
+ * to the next tile's
+ */
+static void tile_first_restore(SceneLayer *layer)
+{
+    for (int t = layer_num_tiles(layer); t > 0; t--)
+        layer->tile_first[t] = layer->tile_first[t - 1];
+    layer->tile_first[0] = 0;
+}
+
+/* Set the tile box of an aliased layer from the pixel columns its edges
+ * cross, as edge_scan_row() truncates them
+ * Returns: false if every crossing lies right of the screen
+ */
+static bool edge_layer_box(SceneLayer *layer, const RenderScene *scene, int num_edges)
+{
+    int c_min = INT_MAX;
+    int c_max = INT_MIN;
+    int y_end = 0;
+    for (int i = 0; i < num_edges; i++)
+    {
+        const Edge *e = &layer->edges[i];
+        int c0 = coord_trunc(e->x);
+        int c1 = coord_trunc(edge_x(e, e->y_end - 1));
+        c_min = c0 < c_min ? c0 : c_min;
+        c_min = c1 < c_min ? c1 : c_min;
+        c_max = c0 > c_max ? c0 : c_max;
+        c_max = c1 > c_max ? c1 : c_max;
+        if (e->y_end > y_end)
+            y_end = e->y_end;
+    }
+    if (c_min < 0)
+        c_min = 0;
+    if (c_min >= scene->width)
+        return false;
+
+    c_max = c_max < scene->width ? (c_max > 0 ? c_max : 0) + 1 : scene->width;
+    layer_set_box(layer, c_min, layer->edges[0].y_start, c_max, y_end);
+    return true;
+}
+
+/* Tile columns in which an edge crosses the scanlines of tile row ty
+ * Crossings left of the screen count for tile column 0; those at or past
+ * its right edge are dropped, as the span writer would clip them.
+ * Returns: false if the edge crosses no tile of the row
+ */
+static bool edge_tile_columns(const Edge *e, const RenderScene *scene, int ty, int *first, int *last)
+{
+    int y0 = ty * SCENE_TILE_SIZE;
+    int y1 = y0 + SCENE_TILE_SIZE - 1;
+    if (y0 < e->y_start)
+        y0 = e->y_start;
+    if (y1 > e->y_end - 1)
+        y1 = e->y_end - 1;
+
+    // x is linear in y, so the crossings of the row lie between these two
+    int c0 = coord_trunc(edge_x(e, y0));
+    int c1 = coord_trunc(edge_x(e, y1));
+    if (c0 > c1)
+    {
+        int t = c0;
+        c0 = c1;
+        c1 = t;
+    }
+    if (c0 >= scene->width)
+        return false;
+    if (c1 >= scene->width)
+        c1 = scene->width - 1;
+
+    *first = c0 > 0 ? c0 / SCENE_TILE_SIZE : 0;
+    *last = c1 > 0 ? c1 / SCENE_TILE_SIZE : 0;
+    return true;
+}
+
+/* Count (placing false) or place the edges of an aliased layer by tile */
+static void bin_edges(SceneLayer *layer, const RenderScene *scene, int num_edges, bool placing)
+{
+    for (int i = 0; i < num_edges; i++)
+    {
+        const Edge *e = &layer->edges[i];
+        int ty_last = (e->y_end - 1) / SCENE_TILE_SIZE;
+        for (int ty = e->y_start / SCENE_TILE_SIZE; ty <= ty_last; ty++)
+        {
+            int first, last;
+            if (!edge_tile_columns(e, scene, ty, &first, &last))
+                continue;
+            for (int tx = first; tx <= last; tx++)
+            {
+                uint32_t slot = tile_slot(layer, tx, ty, placing);
+                if (placing)
+                    layer->tile_edges[slot] = i;
+            }
+        }
+    }
+}
+
+/* Count or place a piece of an anti-aliased line lying in tile row ty
+ * The piece runs downwards; it is split where it crosses tile columns.
+ */
+static void bin_row_piece(SceneLayer *layer, const RenderScene *scene, float xa, float ya,
+                          float xb, float yb, float winding, int ty, bool placing)
+{
+    // Only the part left of the screen's right edge can change a pixel
+    float w = (float)scene->width;
+    if (xa >= w && xb >= w)
         return;
+    if (xa > w || xb > w)
+    {
+        float ym = ya + (w - xa) * (yb - ya) / (xb - xa);
+        if (xa > w)
+        {
+            xa = w;
+            ya = ym;
+        }
+        else
+        {
+            xb = w;
+            yb = ym;
+        }
+    }
 
-    // Process each scanline
-    for (int y = screen_min_y; y <= screen_max_y; y++)
+    // A piece on the right edge of the box belongs to its last tile
+    int ca = xa > 0.0f ? (int)(xa / SCENE_TILE_SIZE) : 0;
+    int cb = xb > 0.0f ? (int)(xb / SCENE_TILE_SIZE) : 0;
+    if (ca >= layer->tile_x1)
+        ca = layer->tile_x1 - 1;
+    if (cb >= layer->tile_x1)
+        cb = layer->tile_x1 - 1;
+
+    int step = ca < cb ? 1 : -1;
+    float x = xa;
+    float y = ya;
+    for (int tx = ca;; tx += step)
     {
-        int num_intersections = 0;
+        float x_next = xb;
+        float y_next = yb;
+        if (tx != cb)
+        {
+            // Split on the tile column boundary towards cb
+            x_next = (float)((step > 0 ? tx + 1 : tx) * SCENE_TILE_SIZE);
+            y_next = ya + (x_next - xa) * (yb - ya) / (xb - xa);
+            y_next = y_next < y ? y : (y_next > yb ? yb : y_next);
+        }
 
-        // Find intersections with all path segments
-        for (uint32_t i = 0; i < svg->num_paths; i++)
+        if (y_next > y)
         {
-            Path *path = &svg->paths[i];
-            for (uint32_t j = 0; j < path->num_points; j++)
+            uint32_t slot = tile_slot(layer, tx, ty, placing);
+            if (placing)
             {
-                uint32_t k = (j + 1) % path->num_points;
+                CoverageLine *piece = &layer->pieces[slot];
+                piece->x0 = x;
+                piece->y0 = y;
+                piece->x1 = x_next;
+                piece->y1 = y_next;
+                piece->winding = winding;
+            }
+        }
+        if (tx == cb)
+            break;
+        x = x_next;
+        y = y_next;
+    }
+}
 
-                float y1 = path->points[j].y * scale + offset_y;
-                float y2 = path->points[k].y * scale + offset_y;
+/* Count or place the pieces of an anti-aliased line, cut at tile boundaries
+ * The line is turned to run downwards, flipping its winding, and clipped to
+ * the screen rows. Parts left of the screen stay in tile column 0, whose
+ * coverage buffer folds them onto its first column.
+ */
+static void bin_line(SceneLayer *layer, const RenderScene *scene, const CoverageLine *line, bool placing)
+{
+    float x0 = line->x0, y0 = line->y0;
+    float x1 = line->x1, y1 = line->y1;
+    float winding = line->winding;
+    if (y0 > y1)
+    {
+        float t;
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+        winding = -winding;
+    }
 
-                // Check if segment crosses current scanline
-                if ((y1 <= y && y2 > y) || (y2 <= y && y1 > y))
-                {
-                    float x1 = path->points[j].x * scale + offset_x;
-                    float x2 = path->points[k].x * scale + offset_x;
-
-                    if (num_intersections < MAX_INTERSECTIONS)
-                    {
-                        float x;
-                        if (y1 == y2)
-                        {
-                            x = x1;
-                        }
-                        else
-                        {
-                            // Calculate intersection x-coordinate
-                            x = x1 + (y - y1) * (x2 - x1) / (y2 - y1);
-                        }
-
-                        intersections[num_intersections].x = (int)x;
-                        intersections[num_intersections].is_hole_edge = path->is_hole;
-                        num_intersections++;
-                    }
-                }
+    float h = (float)scene->height;
+    if (y1 <= 0 || y0 >= h)
+        return;
+
+    float dxdy = (x1 - x0) / (y1 - y0);
+    if (y0 < 0)
+    {
+        x0 -= y0 * dxdy;
+        y0 = 0;
+    }
+    if (y1 > h)
+    {
+        x1 -= (y1 - h) * dxdy;
+        y1 = h;
+    }
+
+    float ya = y0;
+    float xa = x0;
+    while (ya < y1)
+    {
+        int ty = (int)(ya / SCENE_TILE_SIZE);
+        float yb = (float)((ty + 1) * SCENE_TILE_SIZE);
+        float xb;
+        if (yb >= y1)
+        {
+            yb = y1;
+            xb = x1;
+        }
+        else
+        {
+            xb = x0 + (yb - y0) * dxdy;
+        }
+        bin_row_piece(layer, scene, xa, ya, xb, yb, winding, ty, placing);
+        xa = xb;
+        ya = yb;
+    }
+}
+
+/* Free the geometry of a layer */
+static void scene_layer_free(SceneLayer *layer)
+{
+    free(layer->edges);
+    free(layer->lines);
+    free(layer->strip_first);
+    free(layer->strip_lines);
+    free(layer->tile_first);
+    free(layer->tile_edges);
+    free(layer->pieces);
+}
+
+/* Count or place every entry of a layer: its edges, or with lines given,
+ * the pieces of those lines
+ */
+static void bin_entries(SceneLayer *layer, const RenderScene *scene, const CoverageLine *lines,
+                        uint32_t count, bool placing)
+{
+    if (!lines)
+    {
+        bin_edges(layer, scene, (int)count, placing);
+        return;
+    }
+    for (uint32_t i = 0; i < count; i++)
+        bin_line(layer, scene, &lines[i], placing);
+}
+
+/* Bin the screen-space geometry of a layer by tile
+ * The layer's tile box must be set. Aliased layers bin their edge table;
+ * anti-aliased layers cut lines into per-tile pieces, after which the lines
+ * themselves are no longer needed.
+ * Returns: 0 on success, -1 on allocation failure
+ */
+static int bin_layer(SceneLayer *layer, RenderScene *scene, const CoverageLine *lines, uint32_t count)
+{
+    layer->tile_first = calloc(layer_num_tiles(layer) + 1, sizeof(uint32_t));
+    if (!layer->tile_first)
+        return -1;
+
+    bin_entries(layer, scene, lines, count, false);
+    uint32_t total = tile_counts_to_first(layer, &scene->max_entries);
+
+    if (lines)
+    {
+        layer->pieces = malloc((total ? total : 1) * sizeof(CoverageLine));
+        if (!layer->pieces)
+            return -1;
+    }
+    else
+    {
+        layer->tile_edges = malloc((total ? total : 1) * sizeof(uint32_t));
+        if (!layer->tile_edges)
+            return -1;
+    }
+
+    bin_entries(layer, scene, lines, count, true);
+    tile_first_restore(layer);
+    return 0;
+}
+
+/* Add a path on top of the scene
+ * Its geometry is transformed into screen space and binned by strip or
+ * tile now, so the path can be freed afterwards. A path with nothing on
+ * screen adds no layer.
+ */
+int render_scene_add_path(RenderScene *scene, const SVGPath *svg)
+{
+    if (scene->num_layers == scene->capacity)
+    {
+        int capacity = scene->capacity ? scene->capacity * 2 : 8;
+        SceneLayer *layers = realloc(scene->layers, capacity * sizeof(SceneLayer));
+        if (!layers)
+            return -1;
+        scene->layers = layers;
+        scene->capacity = capacity;
+    }
+
+    SceneLayer *layer = &scene->layers[scene->num_layers];
+    memset(layer, 0, sizeof(*layer));
+    layer->color = path_color(svg);
+
+    int result;
+    if (scene->mode == RENDER_ANTIALIASED)
+    {
+        uint32_t num_lines;
+        int box[4];
+        CoverageLine *lines = build_coverage_lines(svg, &scene->transform, scene->width, scene->height,
+                                                   &num_lines, box);
+        if (!lines)
+            return 0;
+
+        if (scene->compositor == SCENE_TILES)
+        {
+            layer_set_box(layer, box[0], box[1], box[2], box[3]);
+            result = bin_layer(layer, scene, lines, num_lines);
+            free(lines);
+        }
+        else
+        {
+            layer->lines = lines;
+            layer->box_x0 = box[0];
+            layer->box_width = box[2] - box[0];
+            layer->y_start = box[1];
+            layer->y_end = box[3];
+            result = bin_layer_lines(layer, num_lines, scene->height);
+        }
+    }
+    else
+    {
+        layer->edges = build_edge_table(svg, &scene->transform, scene->height, &layer->num_edges);
+        if (!layer->edges)
+            return 0;
+
+        if (scene->compositor == SCENE_TILES)
+        {
+            result = edge_layer_box(layer, scene, layer->num_edges) ?
+                     bin_layer(layer, scene, NULL, layer->num_edges) : 0;
+        }
+        else
+        {
+            layer->y_start = layer->edges[0].y_start;
+            for (int i = 0; i < layer->num_edges; i++)
+            {
+                if (layer->edges[i].y_end > layer->y_end)
+                    layer->y_end = layer->edges[i].y_end;
             }
+            result = 0;
         }
+    }
+
+    // Nothing binned in a tile means nothing of the layer is on screen
+    bool empty = scene->compositor == SCENE_TILES &&
+                 (!layer->tile_first || layer->tile_first[layer_num_tiles(layer)] == 0);
+    if (result != 0 || empty)
+    {
+        scene_layer_free(layer);
+        return result;
+    }
+    scene->num_layers++;
+    return 0;
+}
+
+/* Strip of a scene being composited by one band
+ * colors holds SCENE_STRIP_ROWS rows; only columns x0[r] to x1[r] of row r
+ * have been drawn, the rest of the row is background.
+ */
+typedef struct
+{
+    uint32_t *colors;
+    int width;
+    uint32_t background;
+    int x0[SCENE_STRIP_ROWS];
+    int x1[SCENE_STRIP_ROWS];
+} SceneStrip;
+
+/* Make columns a to b of strip row r drawable, filling the newly drawn part
+ * of the row with background
+ */
+static uint32_t *strip_touch(SceneStrip *strip, int r, int a, int b)
+{
+    uint32_t *row = strip->colors + (size_t)r * strip->width;
 
-        if (num_intersections > 0)
+    if (strip->x0[r] > strip->x1[r])
+    {
+        fill_u32(row + a, strip->background, b - a + 1);
+        strip->x0[r] = a;
+        strip->x1[r] = b;
+        return row;
+    }
+    if (a < strip->x0[r])
+    {
+        fill_u32(row + a, strip->background, strip->x0[r] - a);
+        strip->x0[r] = a;
+    }
+    if (b > strip->x1[r])
+    {
+        fill_u32(row + strip->x1[r] + 1, strip->background, b - strip->x1[r]);
+        strip->x1[r] = b;
+    }
+    return row;
+}
+
+/* Write strip row r to screen row y as runs of equal color */
+static void strip_emit_row(Framebuffer *fb, const SceneStrip *strip, int r, int y)
+{
+    const uint32_t *row = strip->colors + (size_t)r * strip->width;
+    int x0 = strip->x0[r];
+    int x1 = strip->x1[r];
+
+    int x = 0;
+    while (x < strip->width)
+    {
+        uint32_t color = (x >= x0 && x <= x1) ? row[x] : strip->background;
+        int end = x + 1;
+        while (end < strip->width)
         {
-            // Sort intersections by x-coordinate
-            qsort(intersections, num_intersections, sizeof(Intersection), compare_intersections);
+            if (end >= x0 && end <= x1)
+            {
+                end += run_length_u32(row + end, color, x1 + 1 - end);
+                if (end <= x1)
+                    break;
+            }
+            else if (color == strip->background)
+            {
+                // Undrawn columns are background; skip the whole stretch
+                end = end < x0 ? x0 : strip->width;
+            }
+            else
+            {
+                break;
+            }
+        }
+        fb_fill_span(fb, x, end - 1, y, color);
+        x = end;
+    }
+}
 
-            bool inside_main = false;
-            bool inside_hole = false;
+/* Fill the spans of an aliased layer on strip rows y0 to y1 - 1 */
+static void composite_edges(SceneStrip *strip, const SceneLayer *layer, EdgeScan *scan,
+                            int y0, int y1)
+{
+    for (int y = edge_scan_next_row(scan, y0); y < y1; y = edge_scan_next_row(scan, y + 1))
+    {
+        int num_spans = edge_scan_row(scan, y);
+        for (int i = 0; i < num_spans; i++)
+        {
+            int a = scan->spans[2 * i] > 0 ? scan->spans[2 * i] : 0;
+            int b = scan->spans[2 * i + 1] < strip->width ? scan->spans[2 * i + 1] : strip->width - 1;
+            if (a > b)
+                continue;
+            uint32_t *row = strip_touch(strip, y - y0, a, b);
+            fill_u32(row + a, layer->color, b - a + 1);
+        }
+    }
+}
 
-            // Convert color components to 32-bit color
-            uint32_t color = (svg->fill_color.r << 16) |
-                             (svg->fill_color.g << 8) |
-                             svg->fill_color.b;
+/* Blend the coverage of an anti-aliased layer into strip rows y0 to y1 - 1
+ * cov has SCENE_STRIP_ROWS rows; rows past the strip are resolved too, so
+ * every cell is zero again afterwards.
+ */
+static void composite_coverage(SceneStrip *strip, const SceneLayer *layer, CoverageBuffer *cov,
+                               uint8_t *alpha, int y0, int y1)
+{
+    int s = y0 / SCENE_STRIP_ROWS;
+    uint32_t first = layer->strip_first[s];
+    uint32_t last = layer->strip_first[s + 1];
+    if (first == last)
+        return;
 
-            // Fill between pairs of intersections
-            for (int i = 0; i < num_intersections - 1; i++)
+    float shift_x = (float)layer->box_x0;
+    float shift_y = (float)y0;
+    for (uint32_t i = first; i < last; i++)
+    {
+        const CoverageLine *line = &layer->lines[layer->strip_lines[i]];
+        coverage_add_line(cov, line->x0 - shift_x, line->y0 - shift_y,
+                          line->x1 - shift_x, line->y1 - shift_y, line->winding);
+    }
+
+    for (int r = 0; r < cov->height; r++)
+    {
+        coverage_resolve_row(cov, r, alpha);
+        if (r >= y1 - y0)
+            continue;
+
+        int a = 0;
+        int b = cov->width - 1;
+        while (a <= b && alpha[a] == 0)
+            a++;
+        while (b >= a && alpha[b] == 0)
+            b--;
+        if (a > b)
+            continue;
+
+        uint32_t *row = strip_touch(strip, r, layer->box_x0 + a, layer->box_x0 + b) + layer->box_x0;
+        for (int x = a; x <= b; x++)
+        {
+            if (alpha[x] == 255)
+                row[x] = layer->color;
+            else if (alpha[x] != 0)
+                row[x] = blend_color(layer->color, row[x], alpha[x]);
+        }
+    }
+}
+
+/* Composite the strips of rows y_start to y_end - 1, layer scan state
+ * being set up the first time a layer reaches them
+ * A layer whose scan state cannot be allocated is left out of the strip.
+ */
+static void composite_strips(SceneJob *job, SceneStrip *strip, EdgeScan *scans,
+                             CoverageBuffer *covs, uint8_t *alpha, int y_start, int y_end)
+{
+    const RenderScene *scene = job->scene;
+
+    for (int y0 = y_start; y0 < y_end;)
+    {
+        // Strips follow the global strip grid the AA lines are binned on
+        int y1 = (y0 / SCENE_STRIP_ROWS + 1) * SCENE_STRIP_ROWS;
+        if (y1 > y_end)
+            y1 = y_end;
+
+        for (int r = 0; r < SCENE_STRIP_ROWS; r++)
+        {
+            strip->x0[r] = 1;
+            strip->x1[r] = 0;
+        }
+
+        for (int i = 0; i < scene->num_layers; i++)
+        {
+            const SceneLayer *layer = &scene->layers[i];
+            if (layer->y_end <= y0 || layer->y_start >= y1)
+                continue;
+
+            if (scene->mode == RENDER_ANTIALIASED)
             {
-                if (intersections[i].is_hole_edge)
-                {
-                    inside_hole = !inside_hole;
-                }
-                else
+                if (!covs[i].cells &&
+                    coverage_init(&covs[i], layer->box_width, SCENE_STRIP_ROWS) != 0)
                 {
-                    inside_main = !inside_main;
+                    scene_job_fail(job);
+                    continue;
                 }
-
-                // Only fill if inside main path and not inside hole
-                if (inside_main && !inside_hole)
+                composite_coverage(strip, layer, &covs[i], alpha, y0, y1);
+            }
+            else
+            {
+                if (!scans[i].active &&
+                    edge_scan_init(&scans[i], layer->edges, layer->num_edges, y0) != 0)
                 {
-                    int x_start = intersections[i].x;
-                    int x_end = intersections[i + 1].x;
-
-                    // Clip to screen bounds
-                    if (x_start < 0)
-                        x_start = 0;
-                    if (x_end >= (int)fb->vinfo.xres)
-                        x_end = fb->vinfo.xres - 1;
-
-                    // Fill horizontal span
-                    for (int x = x_start; x <= x_end; x++)
-                    {
-                        set_pixel(fb, x, y, color);
-                    }
+                    scene_job_fail(job);
+                    continue;
                 }
+                composite_edges(strip, layer, &scans[i], y0, y1);
             }
         }
+
+        for (int y = y0; y < y1; y++)
+            strip_emit_row(job->fb, strip, y - y0, y);
+        y0 = y1;
     }
+}
 
-    free(intersections);
+/* Composite rows band_start to band_end - 1 of a scene
+ * Rows are built a strip at a time: every layer that reaches the strip is
+ * drawn in painter's order into a color buffer laid over the background,
+ * then each row goes out as runs of equal color.
+ */
+static void scene_band(void *arg, int band_start, int band_end)
+{
+    SceneJob *job = arg;
+    const RenderScene *scene = job->scene;
+    int num_layers = scene->num_layers;
+
+    int alpha_width = 1;
+    for (int i = 0; i < num_layers; i++)
+    {
+        if (scene->layers[i].box_width > alpha_width)
+            alpha_width = scene->layers[i].box_width;
+    }
+
+    SceneStrip strip;
+    strip.width = job->width;
+    strip.background = scene->background;
+    strip.colors = malloc((size_t)SCENE_STRIP_ROWS * job->width * sizeof(uint32_t));
+    EdgeScan *scans = calloc(num_layers + 1, sizeof(EdgeScan));
+    CoverageBuffer *covs = calloc(num_layers + 1, sizeof(CoverageBuffer));
+    uint8_t *alpha = malloc(alpha_width);
+
+    if (strip.colors && scans && covs && alpha)
+    {
+        composite_strips(job, &strip, scans, covs, alpha, band_start, band_end);
+
+        for (int i = 0; i < num_layers; i++)
+        {
+            if (scans[i].active)
+                edge_scan_free(&scans[i]);
+            if (covs[i].cells)
+                coverage_free(&covs[i]);
+        }
+    }
+    else if (band_start < band_end)
+    {
+        scene_job_fail(job);
+    }
+
+    free(scans);
+    free(covs);
+    free(alpha);
+    free(strip.colors);
+}
+
+/* Run of equal color starting at column x, ending where the next one starts */
+typedef struct
+{
+    int x;
+    uint32_t color;
+} ColorRun;
+
+/* Tile row of a scene being composited by one band
+ * Layers carry their state along each scanline from tile to tile: aliased
+ * layers their even-odd state, anti-aliased ones their coverage sum. Rows
+ * go out as runs of equal color that may span several tiles.
+ */
+typedef struct
+{
+    Framebuffer *fb;
+    const RenderScene *scene;
+    int width;              // Columns written
+    int ty;                 // Tile row
+    int y0;                 // Its first screen row
+    int rows;               // Its rows on screen
+    uint32_t *colors;       // One tile, SCENE_TILE_SIZE pixels per row
+    CoverageBuffer cov;     // Anti-aliased: coverage of one tile
+    uint8_t alpha[SCENE_TILE_SIZE];
+    ActiveEdge *active;     // Aliased: room for the entries of any tile
+    uint8_t *states;        // Aliased: per layer and row, state left of the tile
+    float *carries;         // Anti-aliased: per layer and row, coverage sum left of the tile
+    int *layers;            // Layers reaching the tile row, in painter's order
+    int num_layers;
+    ColorRun *runs;         // Per row, room for a run starting on every column
+    int num_runs[SCENE_TILE_SIZE];
+    bool runs_even;         // Whether every row's last run has color runs_color
+    uint32_t runs_color;
+} TileRow;
+
+/* Whether a layer has anything in tile (tx, ty) */
+static bool layer_in_tile(const SceneLayer *layer, int tx, int ty)
+{
+    return tx >= layer->tile_x0 && tx < layer->tile_x1 && ty >= layer->tile_y0 && ty < layer->tile_y1;
+}
+
+/* Coverage of a layer over row r of the current tile where no entry of the
+ * layer changes it: full, none, or for anti-aliased layers anything between
+ */
+static uint8_t layer_row_alpha(const TileRow *row, int layer, int r)
+{
+    if (row->scene->mode == RENDER_ANTIALIASED)
+        return coverage_alpha(row->carries[layer * SCENE_TILE_SIZE + r]);
+    return row->states[layer * SCENE_TILE_SIZE + r] == STATE_INSIDE ? 255 : 0;
+}
+
+/* Fill columns a to b of tile row r, if any */
+static void tile_fill(const TileRow *row, int r, int a, int b, uint32_t color)
+{
+    if (a <= b)
+        fill_u32(row->colors + r * SCENE_TILE_SIZE + a, color, b - a + 1);
+}
+
+/* Blend a row of coverage over the first width pixels of tile row r */
+static void tile_blend(const TileRow *row, int r, const uint8_t *alpha, int width, uint32_t color)
+{
+    uint32_t *colors = row->colors + r * SCENE_TILE_SIZE;
+    for (int x = 0; x < width; x++)
+    {
+        if (alpha[x] == 255)
+            colors[x] = color;
+        else if (alpha[x] != 0)
+            colors[x] = blend_color(color, colors[x], alpha[x]);
+    }
 }
 
-/* Render an SVG path to the framebuffer */
-void render_svg_path(Framebuffer *fb, SVGPath *svg, DisplayInfo *display_info)
+/* Fill the spans of an aliased layer over tile column tx, or with draw
+ * false only carry its state across the tile
+ * The tile keeps its own active edge list, fed from its edges in order of
+ * start row as they were binned from the sorted edge table. Only crossings
+ * whose pixel column lies in the tile count, tile column 0 also taking
+ * those left of the screen; spans are those of edge_scan_row(), clipped to
+ * the tile.
+ */
+static void tile_edges(TileRow *row, int index, int tx, uint32_t first, uint32_t last, bool draw)
 {
-    static bool first_path = true;
+    const SceneLayer *layer = &row->scene->layers[index];
+    uint8_t *states = row->states + index * SCENE_TILE_SIZE;
+    ActiveEdge *active = row->active;
+    int x0 = tx * SCENE_TILE_SIZE;
+    int x_last = (x0 + SCENE_TILE_SIZE < row->width ? x0 + SCENE_TILE_SIZE : row->width) - 1;
+    uint32_t next = first;
+    int num_active = 0;
 
-    // Clear screen before rendering first path
-    if (first_path)
+    for (int r = 0; r < row->rows; r++)
     {
-        for (uint32_t y = 0; y < fb->vinfo.yres; y++)
+        int y = row->y0 + r;
+
+        // Rows no edge of the tile crosses keep their state all the way across
+        if (num_active == 0)
+        {
+            int y_next = next < last ? layer->edges[layer->tile_edges[next]].y_start : INT_MAX;
+            if (y_next > y)
+            {
+                if (draw && states[r] == STATE_INSIDE)
+                    tile_fill(row, r, 0, x_last - x0, layer->color);
+                continue;
+            }
+        }
+
+        // Retire edges that ended above this row, then activate those starting by it
+        int kept = 0;
+        for (int i = 0; i < num_active; i++)
+        {
+            if (active[i].edge->y_end > y)
+                active[kept++] = active[i];
+        }
+        num_active = kept;
+        while (next < last && layer->edges[layer->tile_edges[next]].y_start <= y)
+            active[num_active++].edge = &layer->edges[layer->tile_edges[next++]];
+
+        // Insertion sort by x; the list is nearly sorted from the previous row
+        for (int i = 0; i < num_active; i++)
         {
-            for (uint32_t x = 0; x < fb->vinfo.xres; x++)
+            ActiveEdge e = active[i];
+            e.x = edge_x(e.edge, y);
+            int j = i - 1;
+            while (j >= 0 && active[j].x > e.x)
             {
-                set_pixel(fb, x, y, 0x00000000);
+                active[j + 1] = active[j];
+                j--;
             }
+            active[j + 1] = e;
+        }
+
+        uint8_t state = states[r];
+        int start = x0;
+        for (int i = 0; i < num_active; i++)
+        {
+            int c = coord_trunc(active[i].x);
+            if ((c < x0 && x0 > 0) || c >= x0 + SCENE_TILE_SIZE)
+                continue;
+
+            bool was_inside = state == STATE_INSIDE;
+            state ^= STATE_INSIDE;
+            if (state == STATE_INSIDE)
+                start = c > x0 ? c : x0;
+            else if (was_inside && draw)
+                tile_fill(row, r, start - x0, (c < x_last ? c : x_last) - x0, layer->color);
+        }
+        if (state == STATE_INSIDE && draw)
+            tile_fill(row, r, start - x0, x_last - x0, layer->color);
+        states[r] = state;
+    }
+}
+
+/* Paint row r of the current tile with a layer where none of its entries
+ * reaches the row, so its coverage is the same across the tile
+ */
+static void tile_row_flat(TileRow *row, int index, int r, int width)
+{
+    uint32_t color = row->scene->layers[index].color;
+    uint8_t a = layer_row_alpha(row, index, r);
+    if (a == 255)
+    {
+        tile_fill(row, r, 0, width - 1, color);
+    }
+    else if (a != 0)
+    {
+        memset(row->alpha, a, width);
+        tile_blend(row, r, row->alpha, width, color);
+    }
+}
+
+/* Blend the coverage of an anti-aliased layer over tile column tx, or with
+ * draw false only carry its coverage sums across the tile
+ */
+static void tile_coverage(TileRow *row, int index, int tx, uint32_t first, uint32_t last, bool draw)
+{
+    const SceneLayer *layer = &row->scene->layers[index];
+    float *carries = row->carries + index * SCENE_TILE_SIZE;
+    float shift_x = (float)(tx * SCENE_TILE_SIZE);
+    float shift_y = (float)row->y0;
+
+    if (!draw)
+    {
+        // Every piece runs downwards; its sum over a row is its height there
+        for (uint32_t i = first; i < last; i++)
+        {
+            const CoverageLine *piece = &layer->pieces[i];
+            float ya = piece->y0 - shift_y;
+            float yb = piece->y1 - shift_y;
+            for (int r = (int)ya; r < yb && r < SCENE_TILE_SIZE; r++)
+                carries[r] += piece->winding * (fminf((float)(r + 1), yb) - fmaxf((float)r, ya));
+        }
+        return;
+    }
+
+    // Only rows the pieces reach need a prefix sum
+    float y_top = SCENE_TILE_SIZE;
+    float y_bottom = 0.0f;
+    for (uint32_t i = first; i < last; i++)
+    {
+        const CoverageLine *piece = &layer->pieces[i];
+        coverage_add_line(&row->cov, piece->x0 - shift_x, piece->y0 - shift_y,
+                          piece->x1 - shift_x, piece->y1 - shift_y, piece->winding);
+        y_top = fminf(y_top, piece->y0 - shift_y);
+        y_bottom = fmaxf(y_bottom, piece->y1 - shift_y);
+    }
+    int r_first = y_top > 0.0f ? (int)y_top : 0;
+    int r_end = (int)ceilf(y_bottom);
+
+    int width = row->width - (int)shift_x < SCENE_TILE_SIZE ? row->width - (int)shift_x : SCENE_TILE_SIZE;
+    for (int r = 0; r < row->rows; r++)
+    {
+        if (r < r_first || r >= r_end)
+        {
+            tile_row_flat(row, index, r, width);
+            continue;
         }
-        first_path = false;
+        coverage_resolve_row_carry(&row->cov, r, row->alpha, &carries[r]);
+        tile_blend(row, r, row->alpha, width, layer->color);
     }
+}
+
+/* Continue the run of row r at column x with color, writing out the run it ends */
+static void run_extend(TileRow *row, int r, int x, uint32_t color)
+{
+    ColorRun *runs = row->runs + (size_t)r * (row->width + 1);
+    int n = row->num_runs[r];
+    if (runs[n - 1].color == color)
+        return;
+    if (runs[n - 1].x == x)
+    {
+        runs[n - 1].color = color;
+        return;
+    }
+    runs[n].x = x;
+    runs[n].color = color;
+    row->num_runs[r] = n + 1;
+}
+
+/* Composite tile column tx of the current tile row
+ * The topmost layer covering every row of the tile without an entry in it
+ * hides the layers below, which only carry their state across. When no
+ * layer above it reaches into the tile, the tile goes out as a solid fill
+ * without touching the tile buffer; otherwise the layers above are drawn
+ * over it in painter's order.
+ */
+static void composite_tile(TileRow *row, int tx)
+{
+    const RenderScene *scene = row->scene;
+    int x0 = tx * SCENE_TILE_SIZE;
+    int width = row->width - x0 < SCENE_TILE_SIZE ? row->width - x0 : SCENE_TILE_SIZE;
+    bool antialiased = scene->mode == RENDER_ANTIALIASED;
+
+    int base = -1;
+    for (int k = row->num_layers - 1; k >= 0 && base < 0; k--)
+    {
+        int i = row->layers[k];
+        const SceneLayer *layer = &scene->layers[i];
+        if (!layer_in_tile(layer, tx, row->ty))
+            continue;
+        int tile = layer_tile(layer, tx, row->ty);
+        if (layer->tile_first[tile] != layer->tile_first[tile + 1])
+            continue;
+
+        int r = 0;
+        while (r < row->rows && layer_row_alpha(row, i, r) == 255)
+            r++;
+        if (r == row->rows)
+            base = k;
+    }
+
+    for (int k = 0; k < base; k++)
+    {
+        int i = row->layers[k];
+        const SceneLayer *layer = &scene->layers[i];
+        if (!layer_in_tile(layer, tx, row->ty))
+            continue;
+        int tile = layer_tile(layer, tx, row->ty);
+        uint32_t first = layer->tile_first[tile];
+        uint32_t last = layer->tile_first[tile + 1];
+        if (first == last)
+            continue;
+        if (antialiased)
+            tile_coverage(row, i, tx, first, last, false);
+        else
+            tile_edges(row, i, tx, first, last, false);
+    }
+
+    uint32_t base_color = base >= 0 ? scene->layers[row->layers[base]].color : scene->background;
+    bool drawn = false;
+    for (int k = base + 1; k < row->num_layers; k++)
+    {
+        int i = row->layers[k];
+        const SceneLayer *layer = &scene->layers[i];
+        if (!layer_in_tile(layer, tx, row->ty))
+            continue;
+
+        int tile = layer_tile(layer, tx, row->ty);
+        uint32_t first = layer->tile_first[tile];
+        uint32_t last = layer->tile_first[tile + 1];
+        if (first == last)
+        {
+            int r = 0;
+            while (r < row->rows && layer_row_alpha(row, i, r) == 0)
+                r++;
+            if (r == row->rows)
+                continue;
+        }
+
+        if (!drawn)
+        {
+            for (int r = 0; r < row->rows; r++)
+                tile_fill(row, r, 0, width - 1, base_color);
+            drawn = true;
+        }
+
+        if (first == last)
+        {
+            for (int r = 0; r < row->rows; r++)
+                tile_row_flat(row, i, r, width);
+        }
+        else if (antialiased)
+            tile_coverage(row, i, tx, first, last, true);
+        else
+            tile_edges(row, i, tx, first, last, true);
+    }
+
+    if (!drawn)
+    {
+        // A solid tile continuing the rows' runs adds nothing to them
+        if (!row->runs_even || row->runs_color != base_color)
+        {
+            for (int r = 0; r < row->rows; r++)
+                run_extend(row, r, x0, base_color);
+        }
+        row->runs_even = true;
+        row->runs_color = base_color;
+        return;
+    }
+
+    row->runs_even = false;
+    for (int r = 0; r < row->rows; r++)
+    {
+        const uint32_t *colors = row->colors + r * SCENE_TILE_SIZE;
+        for (int x = 0; x < width;)
+        {
+            uint32_t color = colors[x];
+            run_extend(row, r, x0 + x, color);
+            x += run_length_u32(colors + x, color, width - x);
+        }
+    }
+}
+
+/* Composite tile row ty left to right and write out its rows */
+static void composite_tile_row(TileRow *row, int ty, int height)
+{
+    const RenderScene *scene = row->scene;
+    row->ty = ty;
+    row->y0 = ty * SCENE_TILE_SIZE;
+    row->rows = height - row->y0 < SCENE_TILE_SIZE ? height - row->y0 : SCENE_TILE_SIZE;
+
+    // Every layer starts each scanline outside
+    size_t states = (size_t)scene->num_layers * SCENE_TILE_SIZE;
+    if (row->states)
+        memset(row->states, 0, states * sizeof(uint8_t));
+    if (row->carries)
+        memset(row->carries, 0, states * sizeof(float));
+
+    // Rows start as one run of background
+    for (int r = 0; r < row->rows; r++)
+    {
+        ColorRun *runs = row->runs + (size_t)r * (row->width + 1);
+        runs[0].x = 0;
+        runs[0].color = scene->background;
+        row->num_runs[r] = 1;
+    }
+    row->runs_even = true;
+    row->runs_color = scene->background;
+
+    row->num_layers = 0;
+    for (int i = 0; i < scene->num_layers; i++)
+    {
+        if (ty >= scene->layers[i].tile_y0 && ty < scene->layers[i].tile_y1)
+            row->layers[row->num_layers++] = i;
+    }
+
+    int tiles = (row->width + SCENE_TILE_SIZE - 1) / SCENE_TILE_SIZE;
+    for (int tx = 0; tx < tiles; tx++)
+        composite_tile(row, tx);
+
+    for (int r = 0; r < row->rows; r++)
+    {
+        const ColorRun *runs = row->runs + (size_t)r * (row->width + 1);
+        int n = row->num_runs[r];
+        for (int i = 0; i < n; i++)
+        {
+            int x_end = i + 1 < n ? runs[i + 1].x - 1 : row->width - 1;
+            fb_fill_span(row->fb, runs[i].x, x_end, row->y0 + r, runs[i].color);
+        }
+    }
+}
+
+/* Composite the tile rows starting within rows band_start to band_end - 1
+ * A tile row is the unit of work: the band whose rows hold its first row
+ * composites all of it, so each tile is built by exactly one thread.
+ */
+static void tile_band(void *arg, int band_start, int band_end)
+{
+    SceneJob *job = arg;
+    const RenderScene *scene = job->scene;
+    size_t states = (size_t)(scene->num_layers + 1) * SCENE_TILE_SIZE;
+
+    TileRow row;
+    memset(&row, 0, sizeof(row));
+    row.fb = job->fb;
+    row.scene = scene;
+    row.width = job->width;
+    row.colors = malloc(SCENE_TILE_SIZE * SCENE_TILE_SIZE * sizeof(uint32_t));
+    row.layers = malloc((scene->num_layers + 1) * sizeof(int));
+    row.runs = malloc((size_t)SCENE_TILE_SIZE * (job->width + 1) * sizeof(ColorRun));
+
+    bool ready = row.colors && row.layers && row.runs;
+    if (scene->mode == RENDER_ANTIALIASED)
+    {
+        row.carries = malloc(states * sizeof(float));
+        ready = ready && row.carries && coverage_init(&row.cov, SCENE_TILE_SIZE, SCENE_TILE_SIZE) == 0;
+    }
+    else
+    {
+        row.states = malloc(states * sizeof(uint8_t));
+        row.active = malloc((scene->max_entries + 1) * sizeof(ActiveEdge));
+        ready = ready && row.states && row.active;
+    }
+
+    int ty_end = (band_end + SCENE_TILE_SIZE - 1) / SCENE_TILE_SIZE;
+    int ty_start = (band_start + SCENE_TILE_SIZE - 1) / SCENE_TILE_SIZE;
+    if (ready)
+    {
+        for (int ty = ty_start; ty < ty_end; ty++)
+            composite_tile_row(&row, ty, job->height);
+    }
+    else if (ty_start < ty_end)
+    {
+        scene_job_fail(job);
+    }
+
+    coverage_free(&row.cov);
+    free(row.active);
+    free(row.states);
+    free(row.carries);
+    free(row.layers);
+    free(row.runs);
+    free(row.colors);
+}
+
+/* Write every pixel of the frame once, in bands across the render pool */
+int render_scene_draw(Framebuffer *fb, const RenderScene *scene)
+{
+    int width = scene->width < (int)fb->vinfo.xres ? scene->width : (int)fb->vinfo.xres;
+    int height = scene->height < (int)fb->vinfo.yres ? scene->height : (int)fb->vinfo.yres;
+    if (width <= 0 || height <= 0)
+        return 0;
+
+    SceneJob job = { fb, scene, width, height, false };
+    run_bands(fb, 0, height, scene->compositor == SCENE_TILES ? tile_band : scene_band, &job);
+    return job.failed ? -1 : 0;
+}
+
+/* Free a scene and the binned geometry of its layers */
+void render_scene_free(RenderScene *scene)
+{
+    if (!scene)
+        return;
 
-    render_path_with_holes(fb, svg, display_info);
+    for (int i = 0; i < scene->num_layers; i++)
+        scene_layer_free(&scene->layers[i]);
+    free(scene->layers);
+    free(scene);
 }
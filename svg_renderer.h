@@ -3,15 +3,78 @@
 
 #include "fbsplash.h"
 #include "svg_types.h"
+#include "thread_pool.h"
+#include "transform.h"
 
-/* Render an SVG path to the framebuffer
- * Handles multiple paths and holes, applies scaling and centering
+/* Rasterization modes */
+typedef enum {
+    RENDER_ALIASED,         // Hard-edged scanline fill (fastest)
+    RENDER_ANTIALIASED      // Exact-area coverage blended into the background
+} RenderMode;
+
+/* How a scene bins its layers and walks the screen when drawn
+ * Strips are faster for the logo and for aliased scenes at every size;
+ * tiles pay off for anti-aliased scenes of many shapes at 4K and above,
+ * where whole tiles under one opaque shape skip the layers below.
+ */
+typedef enum {
+    SCENE_STRIPS,           // Full-width strips of 16 rows (default)
+    SCENE_TILES             // 64x64 tiles, solidly covered ones written as one fill
+} SceneCompositor;
+
+/* Paths composited into one frame
+ * Each path added becomes a layer of screen-space edges. Drawing sweeps the
+ * screen once, resolving painter's order a strip of rows or a tile at a
+ * time, so every pixel, background included, is written exactly once.
+ */
+typedef struct RenderScene RenderScene;
+
+/* Start an empty scene for a display layout
+ * background: Color of every pixel no path covers
+ * Returns: Scene (free with render_scene_free), or NULL on allocation failure
+ */
+RenderScene *render_scene_create(const DisplayInfo *display_info, RenderMode mode, uint32_t background);
+
+/* Composite the scene with the strip (default) or the tile path
+ * Layers are binned for the path when added, so this only takes effect
+ * while the scene is still empty.
+ */
+void render_scene_set_compositor(RenderScene *scene, SceneCompositor compositor);
+
+/* Add a path on top of the paths already in the scene
+ * The path is transformed into screen space now and may be freed afterwards.
+ * A path with nothing on screen adds no layer.
+ * Returns: 0 on success, -1 on allocation failure
+ */
+int render_scene_add_path(RenderScene *scene, const SVGPath *svg);
+
+/* Write the whole frame, split into bands across the render pool
+ * Returns: 0 on success, -1 if a band could not allocate its buffers and
+ *          left some of its rows as they were
+ */
+int render_scene_draw(Framebuffer *fb, const RenderScene *scene);
+
+/* Free a scene and its layers */
+void render_scene_free(RenderScene *scene);
+
+/* Render with pool from now on, or on the calling thread if NULL
+ * Each path's geometry is prepared once and its rows are split into
+ * horizontal bands, one per pool thread; bands write disjoint rows.
+ */
+void set_render_thread_pool(ThreadPool *pool);
+
+/* Fill the whole screen with color, in parallel bands */
+void render_clear(Framebuffer *fb, uint32_t color);
+
+/* Scale factor from SVG units to screen pixels for a display layout
+ * Use to convert screen-space tolerances into path units before flattening
  */
-void render_svg_path(Framebuffer *fb, SVGPath *svg, DisplayInfo *display_info);
+float get_svg_scale(const DisplayInfo *display_info);
 
-/* Rotate an SVG path by the specified angle
- * angle: Must be 90, 180, or 270 degrees
+/* Transform from SVG units to screen pixels for a display layout
+ * Scale, centering and the display rotation are composed into one matrix,
+ * applied once per point while the screen-space edges are built
  */
-void rotate_svg_path(SVGPath *svg, int angle);
+void get_display_transform(const DisplayInfo *display_info, Transform *transform);
 
 #endif
@@ -12,13 +12,29 @@ typedef struct {
     float y;
 } Point;
 
-/* Path structure representing a series of connected points
- * Can be either an outer path or a hole in another path
+/* Coordinate of a flattened path: float, or 16.16 fixed point in builds
+ * with SPLASH_FIXED_POINT (see fixed_point.h)
  */
+#ifdef SPLASH_FIXED_POINT
+typedef int32_t PathCoord;
+
+/* Point of a flattened path */
 typedef struct {
-    Point *points;           // Array of points in the path
-    uint32_t num_points;     // Number of points currently in use
-    uint32_t capacity;       // Allocated capacity for points array
+    PathCoord x;
+    PathCoord y;
+} PathPoint;
+#else
+typedef float PathCoord;
+typedef Point PathPoint;
+#endif
+
+/* Path structure describing one closed sub-path of an SVGPath
+ * Its points are a slice of the SVGPath's shared point array. Can be either
+ * a filled path or a hole, nested inside an odd number of other sub-paths.
+ */
+typedef struct {
+    uint32_t offset;         // Index of the first point in SVGPath.points
+    uint32_t num_points;     // Number of points in the sub-path
     bool is_hole;           // True if this path represents a hole
 } Path;
 
@@ -30,14 +46,53 @@ typedef struct {
     uint8_t a;              // Alpha component (0-255)
 } Color;
 
-/* SVGPath structure representing a complete SVG path
- * Can contain multiple sub-paths including holes
+/* SVGPath structure representing a complete flattened SVG path
+ * Can contain multiple sub-paths including holes. The points of all
+ * sub-paths are stored contiguously, in sub-path order.
  */
 typedef struct {
-    Path *paths;            // Array of paths
-    uint32_t num_paths;     // Number of paths currently in use
-    uint32_t capacity;      // Allocated capacity for paths array
+    PathPoint *points;      // Points of every sub-path
+    uint32_t num_points;    // Number of points across all sub-paths
+    Path *paths;            // Array of sub-path descriptors
+    uint32_t num_paths;     // Number of sub-paths
     Color fill_color;       // Fill color for the path
 } SVGPath;
 
+/* First point of a sub-path of svg */
+static inline const PathPoint *path_points(const SVGPath *svg, const Path *path) {
+    return svg->points + path->offset;
+}
+
+/* SVG viewBox: the user-space rectangle a document draws in */
+typedef struct {
+    float x;                // Left edge in user units
+    float y;                // Top edge in user units
+    float width;            // Width in user units
+    float height;           // Height in user units
+} ViewBox;
+
+/* Drawing commands of an SVGOutline
+ * Each verb consumes the listed number of points from the outline's point array
+ */
+typedef enum {
+    PATH_MOVE,              // Start a new sub-path (1 point)
+    PATH_LINE,              // Straight line (1 point)
+    PATH_CUBIC,             // Cubic Bezier: 2 control points and an end point (3 points)
+    PATH_CLOSE              // Line back to the sub-path start (0 points)
+} PathVerb;
+
+/* SVGOutline structure holding a parsed but not yet flattened SVG path
+ * Curves are kept exact so they can be flattened once the on-screen
+ * scale is known
+ */
+typedef struct {
+    uint8_t *verbs;         // Array of PathVerb values
+    uint32_t num_verbs;     // Number of verbs currently in use
+    uint32_t verb_capacity; // Allocated capacity for verbs array
+    Point *points;          // Points consumed by the verbs, in order
+    uint32_t num_points;    // Number of points currently in use
+    uint32_t point_capacity;// Allocated capacity for points array
+    Color fill_color;       // Fill color for the path
+} SVGOutline;
+
 #endif
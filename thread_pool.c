@@ -0,0 +1,215 @@
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+/* Bands thinner than this are not worth waking a thread for */
+#define MIN_BAND_ROWS 16
+
+/* Upper bound on render threads */
+#define MAX_THREADS 64
+
+struct ThreadPool {
+    pthread_t *workers;          // Worker threads, num_threads - 1 of them
+    int num_threads;             // Render threads including the caller
+    pthread_mutex_t lock;        // Guards everything below
+    pthread_cond_t work_ready;   // Signalled when a new job is posted
+    pthread_cond_t work_done;    // Signalled when the last worker finishes
+    unsigned generation;         // Incremented for every posted job
+    int pending;                 // Workers still running the current job
+    bool shutdown;               // Workers should exit
+    BandFunc fn;                 // Current job
+    void *ctx;                   // Argument for fn
+    int y_start;                 // First row of the job
+    int y_end;                   // One past the last row of the job
+    int num_bands;               // Bands the job is split into
+};
+
+/* Worker startup argument */
+typedef struct {
+    ThreadPool *pool;
+    int index;                   // Band index served by this worker
+} WorkerArg;
+
+/* Rows of band index out of num_bands over y_start to y_end */
+static void band_rows(int y_start, int y_end, int num_bands, int index, int *band_start, int *band_end)
+{
+    long rows = y_end - y_start;
+    *band_start = y_start + (int)(rows * index / num_bands);
+    *band_end = y_start + (int)(rows * (index + 1) / num_bands);
+}
+
+/* Wait for jobs and render this worker's band of each */
+static void *worker_main(void *arg)
+{
+    WorkerArg worker = *(WorkerArg *)arg;
+    ThreadPool *pool = worker.pool;
+    unsigned seen = 0;
+    free(arg);
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;)
+    {
+        while (pool->generation == seen && !pool->shutdown)
+        {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown)
+        {
+            break;
+        }
+        seen = pool->generation;
+
+        BandFunc fn = pool->fn;
+        void *ctx = pool->ctx;
+        int y_start = pool->y_start;
+        int y_end = pool->y_end;
+        int num_bands = pool->num_bands;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (worker.index < num_bands)
+        {
+            int band_start, band_end;
+            band_rows(y_start, y_end, num_bands, worker.index, &band_start, &band_end);
+            fn(ctx, band_start, band_end);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0)
+        {
+            pthread_cond_signal(&pool->work_done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/* Create the pool and start its workers */
+ThreadPool *thread_pool_create(int num_threads)
+{
+    if (num_threads <= 0)
+    {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cpus > 0 ? (int)cpus : 1;
+    }
+    if (num_threads > MAX_THREADS)
+    {
+        num_threads = MAX_THREADS;
+    }
+
+    ThreadPool *pool = calloc(1, sizeof(ThreadPool));
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    pool->workers = calloc(num_threads, sizeof(pthread_t));
+    if (!pool->workers)
+    {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    // The caller renders band 0; workers take the rest
+    pool->num_threads = 1;
+    for (int i = 1; i < num_threads; i++)
+    {
+        WorkerArg *arg = malloc(sizeof(WorkerArg));
+        if (!arg)
+        {
+            break;
+        }
+        arg->pool = pool;
+        arg->index = i;
+
+        if (pthread_create(&pool->workers[i - 1], NULL, worker_main, arg) != 0)
+        {
+            free(arg);
+            break;
+        }
+        pool->num_threads++;
+    }
+
+    return pool;
+}
+
+/* Number of render threads */
+int thread_pool_size(const ThreadPool *pool)
+{
+    return pool ? pool->num_threads : 1;
+}
+
+/* Post a job to the workers, render band 0 and wait for the rest */
+void thread_pool_run_bands(ThreadPool *pool, int y_start, int y_end, BandFunc fn, void *ctx)
+{
+    if (y_start >= y_end)
+    {
+        return;
+    }
+
+    int num_bands = thread_pool_size(pool);
+    int max_bands = (y_end - y_start) / MIN_BAND_ROWS;
+    if (num_bands > max_bands)
+    {
+        num_bands = max_bands;
+    }
+
+    if (num_bands <= 1)
+    {
+        fn(ctx, y_start, y_end);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->y_start = y_start;
+    pool->y_end = y_end;
+    pool->num_bands = num_bands;
+    pool->pending = pool->num_threads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    int band_start, band_end;
+    band_rows(y_start, y_end, num_bands, 0, &band_start, &band_end);
+    fn(ctx, band_start, band_end);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0)
+    {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/* Stop and join the workers */
+void thread_pool_destroy(ThreadPool *pool)
+{
+    if (!pool)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->num_threads - 1; i++)
+    {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->work_done);
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
@@ -0,0 +1,33 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/* Small fixed pool of render threads
+ * Work is handed out as a row range split into one horizontal band per
+ * thread; the calling thread renders the first band itself, so a pool of
+ * N threads starts N - 1 workers.
+ */
+typedef struct ThreadPool ThreadPool;
+
+/* Render rows y_start to y_end - 1 of a band
+ * Bands handed to concurrent calls never share a row
+ */
+typedef void (*BandFunc)(void *ctx, int y_start, int y_end);
+
+/* Start a pool
+ * num_threads: Total render threads, <= 0 for one per online CPU
+ * Returns: Pool, or NULL on failure
+ */
+ThreadPool *thread_pool_create(int num_threads);
+
+/* Number of render threads, including the caller */
+int thread_pool_size(const ThreadPool *pool);
+
+/* Split rows y_start to y_end - 1 into bands and run fn on all of them
+ * Returns once every band is done. A NULL pool runs a single band inline.
+ */
+void thread_pool_run_bands(ThreadPool *pool, int y_start, int y_end, BandFunc fn, void *ctx);
+
+/* Stop the workers and free the pool */
+void thread_pool_destroy(ThreadPool *pool);
+
+#endif
@@ -0,0 +1,140 @@
+#include <math.h>
+#include "transform.h"
+
+/* Cosine and sine of a clockwise rotation, exact for multiples of 90 degrees */
+static void rotation_cos_sin(int degrees, float *cos_angle, float *sin_angle)
+{
+    degrees %= 360;
+    if (degrees < 0)
+    {
+        degrees += 360;
+    }
+
+    switch (degrees)
+    {
+        case 0:
+            *cos_angle = 1.0f;
+            *sin_angle = 0.0f;
+            break;
+        case 90:
+            *cos_angle = 0.0f;
+            *sin_angle = 1.0f;
+            break;
+        case 180:
+            *cos_angle = -1.0f;
+            *sin_angle = 0.0f;
+            break;
+        case 270:
+            *cos_angle = 0.0f;
+            *sin_angle = -1.0f;
+            break;
+        default:
+            *cos_angle = cosf(degrees * (float)M_PI / 180.0f);
+            *sin_angle = sinf(degrees * (float)M_PI / 180.0f);
+            break;
+    }
+}
+
+/* Identity: maps every point to itself */
+Transform transform_identity(void)
+{
+    Transform t = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+    return t;
+}
+
+/* Rotation about the origin */
+Transform transform_rotate(int degrees)
+{
+    float cos_angle, sin_angle;
+    rotation_cos_sin(degrees, &cos_angle, &sin_angle);
+
+    Transform t = { cos_angle, sin_angle, -sin_angle, cos_angle, 0.0f, 0.0f };
+    return t;
+}
+
+/* Per-axis scale about the origin */
+Transform transform_scale(float sx, float sy)
+{
+    Transform t = { sx, 0.0f, 0.0f, sy, 0.0f, 0.0f };
+    return t;
+}
+
+/* Translation */
+Transform transform_translate(float tx, float ty)
+{
+    Transform t = { 1.0f, 0.0f, 0.0f, 1.0f, tx, ty };
+    return t;
+}
+
+/* first * second: map through second, then through first */
+Transform transform_multiply(const Transform *first, const Transform *second)
+{
+    Transform t;
+    t.a = first->a * second->a + first->c * second->b;
+    t.b = first->b * second->a + first->d * second->b;
+    t.c = first->a * second->c + first->c * second->d;
+    t.d = first->b * second->c + first->d * second->d;
+    t.e = first->a * second->e + first->c * second->f + first->e;
+    t.f = first->b * second->e + first->d * second->f + first->f;
+    return t;
+}
+
+/* Path transform of t: t itself, or its coefficients rounded to fixed point */
+PathTransform transform_for_paths(const Transform *t)
+{
+#ifdef SPLASH_FIXED_POINT
+    PathTransform r = {
+        coord_from_float(t->a), coord_from_float(t->b),
+        coord_from_float(t->c), coord_from_float(t->d),
+        coord_from_float(t->e), coord_from_float(t->f)
+    };
+    return r;
+#else
+    return *t;
+#endif
+}
+
+/* Rectangle of a layout rotated about a center, in whole pixels */
+void transform_rotate_rect(int degrees, int center_x, int center_y, int *x, int *y,
+                           int *width, int *height)
+{
+    int cx = center_x;
+    int cy = center_y;
+    int rx = *x;
+    int ry = *y;
+    int w = *width;
+    int h = *height;
+
+    switch (degrees)
+    {
+        case 90:
+            *x = cx + cy - (ry + h);
+            *y = cy - cx + rx;
+            *width = h;
+            *height = w;
+            break;
+        case 180:
+            *x = 2 * cx - (rx + w);
+            *y = 2 * cy - (ry + h);
+            break;
+        case 270:
+            *x = cx - cy + ry;
+            *y = cx + cy - (rx + w);
+            *width = h;
+            *height = w;
+            break;
+        default:
+            break;
+    }
+}
+
+/* Bounding box of a rotated rectangle */
+void transform_rotated_extents(int degrees, float width, float height,
+                               float *rotated_width, float *rotated_height)
+{
+    float cos_angle, sin_angle;
+    rotation_cos_sin(degrees, &cos_angle, &sin_angle);
+
+    *rotated_width = width * fabsf(cos_angle) + height * fabsf(sin_angle);
+    *rotated_height = width * fabsf(sin_angle) + height * fabsf(cos_angle);
+}
@@ -0,0 +1,102 @@
+#ifndef TRANSFORM_H
+#define TRANSFORM_H
+
+#include "svg_types.h"
+#include "fixed_point.h"
+
+/* 2x3 affine transform in SVG matrix order
+ * Maps (x, y) to (a*x + c*y + e, b*x + d*y + f). Rotation, mirroring, scale
+ * and translation compose into one matrix, so geometry is mapped in a
+ * single multiply-add per coordinate.
+ */
+typedef struct {
+    float a, b;
+    float c, d;
+    float e, f;
+} Transform;
+
+/* The identity transform */
+Transform transform_identity(void);
+
+/* Clockwise rotation (y pointing down) by degrees about the origin
+ * Multiples of 90 use exact sines and cosines
+ */
+Transform transform_rotate(int degrees);
+
+/* Scale by sx and sy; a negative factor mirrors that axis */
+Transform transform_scale(float sx, float sy);
+
+/* Translate by tx and ty */
+Transform transform_translate(float tx, float ty);
+
+/* Compose two transforms: the result applies second, then first */
+Transform transform_multiply(const Transform *first, const Transform *second);
+
+/* Apply a transform to a point */
+static inline Point transform_point(const Transform *t, Point p)
+{
+    Point r = { t->a * p.x + t->c * p.y + t->e, t->b * p.x + t->d * p.y + t->f };
+    return r;
+}
+
+/* A transform in the arithmetic of flattened paths: the float transform
+ * itself, or its coefficients in 16.16 fixed point under SPLASH_FIXED_POINT
+ */
+#ifdef SPLASH_FIXED_POINT
+typedef struct {
+    PathCoord a, b;
+    PathCoord c, d;
+    PathCoord e, f;
+} PathTransform;
+#else
+typedef Transform PathTransform;
+#endif
+
+/* Convert a transform for mapping flattened path points */
+PathTransform transform_for_paths(const Transform *t);
+
+/* Apply a path transform to a flattened point
+ * In fixed point both products are taken in 64 bits and rounded once, and
+ * the result is clamped to FIXED_COORD_LIMIT. In float the result is
+ * clamped to FLOAT_COORD_LIMIT, infinities included; NaN becomes the
+ * negative limit.
+ */
+static inline PathPoint transform_path_point(const PathTransform *t, PathPoint p)
+{
+#ifdef SPLASH_FIXED_POINT
+    const int64_t half = FIXED_ONE / 2;
+    const int64_t limit = (int64_t)FIXED_COORD_LIMIT << FIXED_SHIFT;
+    int64_t x = (((int64_t)t->a * p.x + (int64_t)t->c * p.y + half) >> FIXED_SHIFT) + t->e;
+    int64_t y = (((int64_t)t->b * p.x + (int64_t)t->d * p.y + half) >> FIXED_SHIFT) + t->f;
+    x = x < -limit ? -limit : (x > limit ? limit : x);
+    y = y < -limit ? -limit : (y > limit ? limit : y);
+    PathPoint r = { (PathCoord)x, (PathCoord)y };
+    return r;
+#else
+    Point r = transform_point(t, p);
+    r.x = fminf(fmaxf(r.x, -FLOAT_COORD_LIMIT), FLOAT_COORD_LIMIT);
+    r.y = fminf(fmaxf(r.y, -FLOAT_COORD_LIMIT), FLOAT_COORD_LIMIT);
+    return r;
+#endif
+}
+
+/* Whether a transform mirrors, reversing the orientation of outlines */
+static inline bool transform_mirrors(const Transform *t)
+{
+    return t->a * t->d - t->b * t->c < 0.0f;
+}
+
+/* Map a width x height rectangle at (x, y) of an upright layout onto a
+ * screen rotated clockwise by degrees about (center_x, center_y)
+ * Only multiples of 90 rotate; other angles leave the rectangle as is.
+ */
+void transform_rotate_rect(int degrees, int center_x, int center_y, int *x, int *y,
+                           int *width, int *height);
+
+/* Width and height of the axis-aligned box holding a width x height
+ * rectangle rotated by degrees
+ */
+void transform_rotated_extents(int degrees, float width, float height,
+                               float *rotated_width, float *rotated_height);
+
+#endif